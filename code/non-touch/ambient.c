@@ -0,0 +1,112 @@
+#include "ambient.h"
+#include "hardware/structs/systick.h"
+
+#define SYSTICK_MASK        (0x00FFFFFF)
+#define LEVEL_FRACTION      (4)     // fixed point bits of the smoothed levels
+#define TEMPORAL_SHIFT      (2)     // each frame moves a quarter of the way to the new level
+
+// Tokens are read by core1 for every line, so they sit in its scratch bank
+// (SRAM4); the smoothing state is only touched by the capture interrupt on
+// core0 and sits in SRAM5.
+uint16_t __scratch_x("ambient") ambient_tokens[AMBIENT_LINES];
+
+static bool ambient_enabled = false;
+static uint16_t ambient_lut[AMBIENT_LEVELS];
+static uint8_t __scratch_y("ambient") edge_sum[AMBIENT_LINES];     // 0 .. 3 * AMBIENT_EDGE_PIXELS
+static uint16_t __scratch_y("ambient") levels[AMBIENT_LINES];      // smoothed, 0 .. (AMBIENT_LEVELS-1) << LEVEL_FRACTION
+static uint32_t last_frame_cycles;
+static uint32_t max_frame_cycles;
+
+static uint32_t lerp_rgb888(uint32_t from, uint32_t to, int step)
+{
+    uint32_t color = 0;
+    for (int shift = 0; shift < 24; shift += 8)
+    {
+        uint32_t f = (from >> shift) & 0xFF;
+        uint32_t t = (to >> shift) & 0xFF;
+        color |= (((f * (AMBIENT_STEPS - step)) + (t * step)) / AMBIENT_STEPS) << shift;
+    }
+    return color;
+}
+
+// Colors from each scheme shade to the next, rebuilt with the scheme LUTs
+void build_ambient_lut(void)
+{
+    for (int level = 0; level < AMBIENT_LEVELS; level++)
+    {
+        uint8_t shade = level / AMBIENT_STEPS;
+        uint8_t next = shade < 3 ? shade + 1 : shade;
+        uint32_t from = get_scheme_pixel_color(shade | (shade << 2));
+        uint32_t to = get_scheme_pixel_color(next | (next << 2));
+        ambient_lut[level] = rgb888_to_rgb222_nearest(lerp_rgb888(from, to, level % AMBIENT_STEPS));
+    }
+}
+
+bool __not_in_flash_func(get_ambient_enabled)(void)
+{
+    return ambient_enabled;
+}
+
+void set_ambient_enabled(bool enabled)
+{
+    if (enabled)
+        max_frame_cycles = 0;
+    ambient_enabled = enabled;
+}
+
+// Sums the AMBIENT_EDGE_PIXELS nearest the border on each output line,
+// smooths them across lines [1 2 2 2 1]/8 and across frames, then maps each
+// line to its color.  Runs once per frame in VBLANK.  The framebuffer is in
+// output order, so the border edge is the end of every row whatever the
+// orientation.
+void __not_in_flash_func(ambient_end_frame)(const uint8_t* framebuffer, uint16_t row_length, uint16_t lines)
+{
+    uint32_t start = systick_hw->cvr;
+
+    lines = lines > AMBIENT_LINES ? AMBIENT_LINES : lines;
+
+    const uint8_t* edge = framebuffer + row_length - AMBIENT_EDGE_PIXELS;
+    for (uint16_t line = 0; line < lines; line++)
+    {
+        uint8_t sum = 0;
+        for (int i = 0; i < AMBIENT_EDGE_PIXELS; i++)
+            sum += SHADE_CURRENT(edge[i]);
+        edge_sum[line] = sum;
+        edge += row_length;
+    }
+
+    for (uint16_t line = 0; line < lines; line++)
+    {
+        uint16_t sum = 0;
+        for (int tap = -2; tap <= 2; tap++)
+        {
+            int l = line + tap;
+            l = l < 0 ? 0 : (l >= lines ? lines - 1 : l);
+            sum += edge_sum[l] * ((tap == -2 || tap == 2) ? 1 : 2);
+        }
+
+        // sum/8 is 0 .. 3*AMBIENT_EDGE_PIXELS, scaled to the LUT in fixed point
+        int32_t target = (sum * ((AMBIENT_LEVELS - 1) << LEVEL_FRACTION)) / (8 * 3 * AMBIENT_EDGE_PIXELS);
+        int32_t level = levels[line];
+        level += (target - level) / (1 << TEMPORAL_SHIFT);
+        levels[line] = level;
+
+        ambient_tokens[line] = ambient_lut[(level + (1 << (LEVEL_FRACTION - 1))) >> LEVEL_FRACTION];
+    }
+
+    last_frame_cycles = (start - systick_hw->cvr) & SYSTICK_MASK;
+    if (last_frame_cycles > max_frame_cycles)
+        max_frame_cycles = last_frame_cycles;
+}
+
+// Cycles spent on the last VBLANK pass, from the capture core's SysTick
+// that main() leaves free running
+uint32_t ambient_get_frame_cycles(void)
+{
+    return last_frame_cycles;
+}
+
+uint32_t ambient_get_max_frame_cycles(void)
+{
+    return max_frame_cycles;
+}
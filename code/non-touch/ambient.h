@@ -0,0 +1,25 @@
+#ifndef AMBIENT_H
+#define AMBIENT_H
+
+#include "pico/stdlib.h"
+#include "colors.h"
+
+// Ambient border:  the panel background beside the game window follows the
+// shades along the nearby edge of the game.  Edge shades are summed and
+// smoothed across output lines and frames during VBLANK, so a scanline only
+// loads one precomputed color.
+#define AMBIENT_LINES           (160)   // most output lines of any orientation (DMG_PIXELS_X)
+#define AMBIENT_EDGE_PIXELS     (4)     // pixels nearest the border that are sampled
+#define AMBIENT_STEPS           (4)     // interpolated colors between adjacent shades
+#define AMBIENT_LEVELS          (3 * AMBIENT_STEPS + 1)
+
+void build_ambient_lut(void);
+bool get_ambient_enabled(void);
+void set_ambient_enabled(bool enabled);
+void ambient_end_frame(const uint8_t* framebuffer, uint16_t row_length, uint16_t lines);
+uint32_t ambient_get_frame_cycles(void);
+uint32_t ambient_get_max_frame_cycles(void);
+
+extern uint16_t ambient_tokens[AMBIENT_LINES];
+
+#endif // AMBIENT_H
@@ -0,0 +1,215 @@
+#include <string.h>
+#include "pico/scanvideo.h"
+#include "pico/scanvideo/composable_scanline.h"
+#include "hardware/dma.h"
+#include "hardware/regs/addressmap.h"
+#include "artwork.h"
+#include "colors.h"
+
+#define MIN_RUN     3
+
+static const artwork_t* volatile skin = &artwork_skins[0];
+static int skin_index = 0;
+static uint16_t __scratch_x("artwork") palette_tokens[ARTWORK_MAX_COLORS];
+
+// Two row slots -- the line being drawn and the next one in flight.  Both
+// these and the palette tokens are read by core1 only, from its scratch
+// bank (SRAM4).
+static uint32_t __scratch_x("artwork") row_cache[2][ARTWORK_MAX_ROW_WORDS];
+static const uint32_t* row_cache_source[2];
+static volatile int dma_channel = -1;      // rows are copied by core1 until set
+
+static void build_palette_tokens(void)
+{
+    const artwork_t* art = skin;
+    for (uint8_t i = 1; i < art->palette_count; i++)
+    {
+        palette_tokens[i] = rgb888_to_rgb222_nearest(art->palette[i]);
+    }
+}
+
+void ARTWORK_init(void)
+{
+    // Call once scanvideo is set up -- it claims a fixed channel, and
+    // panics if that is already taken
+    int channel = dma_claim_unused_channel(false);
+    if (channel >= 0)
+    {
+        dma_channel_config c = dma_channel_get_default_config(channel);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, true);
+        dma_channel_set_config(channel, &c, false);
+        dma_channel = channel;
+    }
+    build_palette_tokens();
+}
+
+void ARTWORK_change(int direction)
+{
+    skin_index += direction;
+    if (skin_index < 0)
+        skin_index = artwork_skin_count - 1;
+    else if (skin_index >= artwork_skin_count)
+        skin_index = 0;
+
+    skin = &artwork_skins[skin_index];
+    build_palette_tokens();
+}
+
+int ARTWORK_get_index(void)
+{
+    return skin_index;
+}
+
+const char* ARTWORK_get_name(void)
+{
+    return skin->name;
+}
+
+// One solid run of length output pixels
+uint16_t* __not_in_flash_func(ARTWORK_run)(uint16_t* p16, uint16_t color, uint16_t length)
+{
+    if (length >= MIN_RUN)
+    {
+        *p16++ = COMPOSABLE_COLOR_RUN;
+        *p16++ = color;
+        *p16++ = length - MIN_RUN;
+    }
+    else if (length == 2)
+    {
+        *p16++ = COMPOSABLE_RAW_2P;
+        *p16++ = color;
+        *p16++ = color;
+    }
+    else if (length == 1)
+    {
+        *p16++ = COMPOSABLE_RAW_1P;
+        *p16++ = color;
+    }
+    return p16;
+}
+
+// Rows are read through the non-allocating XIP alias so the prefetch does
+// not evict code the render loop is running from the flash cache.
+static inline const uint32_t* uncached(const uint32_t* source)
+{
+    uintptr_t address = (uintptr_t)source;
+    if (address >= XIP_BASE && address < XIP_NOALLOC_BASE)
+        address += XIP_NOCACHE_NOALLOC_BASE - XIP_BASE;
+    return (const uint32_t*)address;
+}
+
+static void fetch_row(uint8_t slot, const uint32_t* source, uint16_t words)
+{
+    if (words > ARTWORK_MAX_ROW_WORDS)
+        words = ARTWORK_MAX_ROW_WORDS;
+
+    int channel = dma_channel;
+    row_cache_source[slot] = source;
+    if (channel >= 0)
+    {
+        dma_channel_set_read_addr(channel, uncached(source), false);
+        dma_channel_set_write_addr(channel, row_cache[slot], false);
+        dma_channel_set_trans_count(channel, words, true);
+    }
+    else
+    {
+        memcpy(row_cache[slot], source, words * sizeof(uint32_t));
+    }
+}
+
+// Row for line_index from SRAM, then starts the fetch of the row after it
+static const uint8_t* __not_in_flash_func(get_row)(const artwork_t* art, uint8_t line_index)
+{
+    uint8_t row = line_index < ARTWORK_HEIGHT ? line_index : ARTWORK_HEIGHT - 1;
+    uint8_t slot = row & 1;
+    const uint32_t* source = &art->data[art->rows[row]];
+
+    if (dma_channel >= 0)
+        dma_channel_wait_for_finish_blocking(dma_channel);
+
+    if (row_cache_source[slot] != source)
+    {
+        // first line of a frame after a skin change -- nothing was prefetched
+        fetch_row(slot, source, art->rows[row + 1] - art->rows[row]);
+        if (dma_channel >= 0)
+            dma_channel_wait_for_finish_blocking(dma_channel);
+    }
+
+    uint8_t next = row + 1 < ARTWORK_HEIGHT ? row + 1 : 0;
+    const uint32_t* next_source = &art->data[art->rows[next]];
+    if (next != row && row_cache_source[next & 1] != next_source)
+    {
+        fetch_row(next & 1, next_source, art->rows[next + 1] - art->rows[next]);
+    }
+
+    return (const uint8_t*)row_cache[slot];
+}
+
+static inline const uint8_t* next_run(const uint8_t* run, uint16_t* length, uint16_t* color)
+{
+    *length = run[0];
+    *color = palette_tokens[run[1]];
+    if (*length == 0)
+    {
+        // past the end of the row -- carry on in the background color
+        *color = palette_tokens[0];
+        *length = ARTWORK_WIDTH;
+        return run;
+    }
+    return run + 2;
+}
+
+// Draws width DMG pixels of artwork (scale output pixels each), with the
+// overlay spans (sorted by x) drawn over it.  Palette index 0 is drawn in
+// the line's background color.
+uint16_t* __not_in_flash_func(ARTWORK_render_line)(uint16_t* p16, uint8_t line_index, uint16_t width, uint8_t scale, uint16_t background, const artwork_span_t* overlay, uint8_t overlay_count)
+{
+    palette_tokens[0] = background;
+
+    const uint8_t* run = get_row(skin, line_index);
+    const artwork_span_t* overlay_end = overlay + overlay_count;
+    uint16_t run_left = 0;
+    uint16_t run_color = background;
+    uint16_t x = 0;
+
+    while (x < width)
+    {
+        if (overlay < overlay_end && x >= overlay->x)
+        {
+            uint16_t length = overlay->length;
+            if (length > width - x)
+                length = width - x;
+            p16 = ARTWORK_run(p16, overlay->color, length * scale);
+            x += length;
+            overlay++;
+
+            // skip the artwork underneath
+            while (length > 0)
+            {
+                if (run_left == 0)
+                    run = next_run(run, &run_left, &run_color);
+                uint16_t skip = run_left < length ? run_left : length;
+                run_left -= skip;
+                length -= skip;
+            }
+            continue;
+        }
+
+        if (run_left == 0)
+            run = next_run(run, &run_left, &run_color);
+
+        uint16_t length = run_left;
+        if (length > width - x)
+            length = width - x;
+        if (overlay < overlay_end && x + length > overlay->x)
+            length = overlay->x - x;
+
+        p16 = ARTWORK_run(p16, run_color, length * scale);
+        x += length;
+        run_left -= length;
+    }
+
+    return p16;
+}
@@ -0,0 +1,43 @@
+#ifndef ARTWORK_H
+#define ARTWORK_H
+
+#include "pico/stdlib.h"
+
+// Skins for the panel area beside the game window.  Images live in flash
+// as palette indexed run length rows (see tools/artwork_gen.py), one row per
+// output line, stored in line order so reads stay sequential for XIP.  The
+// row for the next line is fetched into SRAM by DMA while the current one is
+// drawn, so a flash cache miss never lands on the scanline deadline.
+#define ARTWORK_WIDTH           (123)
+#define ARTWORK_HEIGHT          (160)
+#define ARTWORK_MAX_ROW_WORDS   (32)
+#define ARTWORK_MAX_COLORS      (16)
+
+typedef struct artwork_t
+{
+    const char* name;
+    uint8_t palette_count;
+    const uint32_t* palette;        // RGB888 -- index 0 is drawn in the panel background color
+    const uint16_t* rows;           // ARTWORK_HEIGHT + 1 word offsets into data
+    const uint32_t* data;           // (length, palette index) byte pairs, rows padded to a word
+} artwork_t;
+
+// Opaque span drawn over the artwork, in DMG pixels
+typedef struct artwork_span_t
+{
+    uint8_t x;
+    uint8_t length;
+    uint16_t color;
+} artwork_span_t;
+
+extern const artwork_t artwork_skins[];
+extern const uint8_t artwork_skin_count;
+
+void ARTWORK_init(void);
+void ARTWORK_change(int direction);
+int ARTWORK_get_index(void);
+const char* ARTWORK_get_name(void);
+uint16_t* ARTWORK_run(uint16_t* p16, uint16_t color, uint16_t length);
+uint16_t* ARTWORK_render_line(uint16_t* p16, uint8_t line_index, uint16_t width, uint8_t scale, uint16_t background, const artwork_span_t* overlay, uint8_t overlay_count);
+
+#endif // ARTWORK_H
@@ -0,0 +1,236 @@
+// Generated by tools/artwork_gen.py -- do not edit by hand
+
+#include "artwork.h"
+
+static const uint32_t plain_palette[] = { 0x000000 };
+
+static const uint16_t plain_rows[ARTWORK_HEIGHT + 1] = 
+{
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+    12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23,
+    24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35,
+    36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47,
+    48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59,
+    60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71,
+    72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83,
+    84, 85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95,
+    96, 97, 98, 99, 100, 101, 102, 103, 104, 105, 106, 107,
+    108, 109, 110, 111, 112, 113, 114, 115, 116, 117, 118, 119,
+    120, 121, 122, 123, 124, 125, 126, 127, 128, 129, 130, 131,
+    132, 133, 134, 135, 136, 137, 138, 139, 140, 141, 142, 143,
+    144, 145, 146, 147, 148, 149, 150, 151, 152, 153, 154, 155,
+    156, 157, 158, 159, 160,
+};
+
+static const uint32_t plain_data[] = 
+{
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+    0x0000007B, 0x0000007B, 0x0000007B, 0x0000007B,
+};
+
+static const uint32_t dmg_palette[] = { 0x000000, 0x8C8A94, 0x5A5A66, 0x7B1838, 0x29296B, 0xF70000 };
+
+static const uint16_t dmg_rows[ARTWORK_HEIGHT + 1] = 
+{
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 14,
+    16, 20, 24, 28, 32, 36, 40, 44, 48, 53, 58, 63,
+    68, 73, 78, 83, 88, 93, 97, 101, 105, 109, 113, 117,
+    121, 125, 129, 133, 137, 141, 145, 149, 153, 157, 161, 165,
+    169, 173, 177, 181, 185, 189, 193, 197, 201, 205, 209, 213,
+    217, 221, 225, 229, 233, 237, 241, 245, 249, 253, 257, 261,
+    265, 269, 273, 277, 281, 285, 289, 293, 297, 301, 305, 309,
+    313, 317, 321, 325, 329, 333, 337, 341, 345, 349, 353, 357,
+    361, 365, 369, 373, 377, 381, 385, 389, 393, 397, 401, 405,
+    409, 413, 417, 421, 425, 429, 433, 437, 441, 445, 449, 453,
+    457, 461, 465, 469, 473, 477, 481, 485, 489, 493, 497, 501,
+    505, 509, 513, 517, 521, 525, 529, 533, 537, 541, 545, 549,
+    553, 557, 561, 565, 569, 571, 573, 575, 577, 578, 579, 580,
+    581, 582, 583, 584, 585,
+};
+
+static const uint32_t dmg_data[] = 
+{
+    0x0000017B, 0x0000017B, 0x0000017B, 0x0000017B, 0x0000017B, 0x0000017B,
+    0x0000017B, 0x0000017B, 0x026F0106, 0x00000106, 0x026F0106, 0x00000106,
+    0x026F0106, 0x00000106, 0x026F0106, 0x00000106, 0x02060106, 0x02040302,
+    0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106,
+    0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302,
+    0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106,
+    0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302,
+    0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106,
+    0x02060106, 0x02040302, 0x02140402, 0x024C0501, 0x00000106, 0x02060106,
+    0x02040302, 0x02120402, 0x024A0505, 0x00000106, 0x02060106, 0x02040302,
+    0x02110402, 0x02490507, 0x00000106, 0x02060106, 0x02040302, 0x02110402,
+    0x02490507, 0x00000106, 0x02060106, 0x02040302, 0x02100402, 0x02480509,
+    0x00000106, 0x02060106, 0x02040302, 0x02110402, 0x02490507, 0x00000106,
+    0x02060106, 0x02040302, 0x02110402, 0x02490507, 0x00000106, 0x02060106,
+    0x02040302, 0x02120402, 0x024A0505, 0x00000106, 0x02060106, 0x02040302,
+    0x02140402, 0x024C0501, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x02060106,
+    0x02040302, 0x02610402, 0x00000106, 0x02060106, 0x02040302, 0x02610402,
+    0x00000106, 0x02060106, 0x02040302, 0x02610402, 0x00000106, 0x026F0106,
+    0x00000106, 0x026F0106, 0x00000106, 0x026F0106, 0x00000106, 0x026F0106,
+    0x00000106, 0x0000017B, 0x0000017B, 0x0000017B, 0x0000017B, 0x0000017B,
+    0x0000017B, 0x0000017B, 0x0000017B,
+};
+
+static const uint32_t gradient_palette[] = { 0x000000, 0xFFAA55, 0xFF5555, 0xAA5555, 0xAA0055, 0x550055, 0x000055, 0x000000, 0x000000 };
+
+static const uint16_t gradient_rows[ARTWORK_HEIGHT + 1] = 
+{
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+    12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23,
+    24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35,
+    36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47,
+    48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59,
+    60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71,
+    72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83,
+    84, 85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95,
+    96, 97, 98, 99, 100, 101, 102, 103, 104, 105, 106, 107,
+    108, 109, 110, 111, 112, 113, 114, 115, 116, 117, 118, 119,
+    120, 121, 122, 123, 124, 125, 126, 127, 128, 129, 130, 131,
+    132, 133, 134, 135, 136, 137, 138, 139, 140, 141, 142, 143,
+    144, 145, 146, 147, 148, 149, 150, 151, 152, 153, 154, 155,
+    156, 157, 158, 159, 160,
+};
+
+static const uint32_t gradient_data[] = 
+{
+    0x0000017B, 0x0000017B, 0x0000017B, 0x0000017B, 0x0000017B, 0x0000017B,
+    0x0000017B, 0x0000017B, 0x0000017B, 0x0000017B, 0x0000017B, 0x0000017B,
+    0x0000017B, 0x0000017B, 0x0000017B, 0x0000017B, 0x0000017B, 0x0000017B,
+    0x0000017B, 0x0000017B, 0x0000027B, 0x0000027B, 0x0000027B, 0x0000027B,
+    0x0000027B, 0x0000027B, 0x0000027B, 0x0000027B, 0x0000027B, 0x0000027B,
+    0x0000027B, 0x0000027B, 0x0000027B, 0x0000027B, 0x0000027B, 0x0000027B,
+    0x0000027B, 0x0000027B, 0x0000027B, 0x0000027B, 0x0000037B, 0x0000037B,
+    0x0000037B, 0x0000037B, 0x0000037B, 0x0000037B, 0x0000037B, 0x0000037B,
+    0x0000037B, 0x0000037B, 0x0000037B, 0x0000037B, 0x0000037B, 0x0000037B,
+    0x0000037B, 0x0000037B, 0x0000037B, 0x0000037B, 0x0000037B, 0x0000037B,
+    0x0000047B, 0x0000047B, 0x0000047B, 0x0000047B, 0x0000047B, 0x0000047B,
+    0x0000047B, 0x0000047B, 0x0000047B, 0x0000047B, 0x0000047B, 0x0000047B,
+    0x0000047B, 0x0000047B, 0x0000047B, 0x0000047B, 0x0000047B, 0x0000047B,
+    0x0000047B, 0x0000047B, 0x0000057B, 0x0000057B, 0x0000057B, 0x0000057B,
+    0x0000057B, 0x0000057B, 0x0000057B, 0x0000057B, 0x0000057B, 0x0000057B,
+    0x0000057B, 0x0000057B, 0x0000057B, 0x0000057B, 0x0000057B, 0x0000057B,
+    0x0000057B, 0x0000057B, 0x0000057B, 0x0000057B, 0x0000067B, 0x0000067B,
+    0x0000067B, 0x0000067B, 0x0000067B, 0x0000067B, 0x0000067B, 0x0000067B,
+    0x0000067B, 0x0000067B, 0x0000067B, 0x0000067B, 0x0000067B, 0x0000067B,
+    0x0000067B, 0x0000067B, 0x0000067B, 0x0000067B, 0x0000067B, 0x0000067B,
+    0x0000077B, 0x0000077B, 0x0000077B, 0x0000077B, 0x0000077B, 0x0000077B,
+    0x0000077B, 0x0000077B, 0x0000077B, 0x0000077B, 0x0000077B, 0x0000077B,
+    0x0000077B, 0x0000077B, 0x0000077B, 0x0000077B, 0x0000077B, 0x0000077B,
+    0x0000077B, 0x0000077B, 0x0000087B, 0x0000087B, 0x0000087B, 0x0000087B,
+    0x0000087B, 0x0000087B, 0x0000087B, 0x0000087B, 0x0000087B, 0x0000087B,
+    0x0000087B, 0x0000087B, 0x0000087B, 0x0000087B, 0x0000087B, 0x0000087B,
+    0x0000087B, 0x0000087B, 0x0000087B, 0x0000087B,
+};
+
+const artwork_t artwork_skins[] = 
+{
+    { .name = "PLAIN", .palette_count = 1, .palette = plain_palette, .rows = plain_rows, .data = plain_data },
+    { .name = "DMG", .palette_count = 6, .palette = dmg_palette, .rows = dmg_rows, .data = dmg_data },
+    { .name = "GRADIENT", .palette_count = 9, .palette = gradient_palette, .rows = gradient_rows, .data = gradient_data },
+};
+
+const uint8_t artwork_skin_count = sizeof(artwork_skins) / sizeof(artwork_skins[0]);
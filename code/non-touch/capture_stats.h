@@ -0,0 +1,42 @@
+#ifndef CAPTURE_STATS_H
+#define CAPTURE_STATS_H
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+// Capture health.  The capture interrupt on core0 folds each frame in as it
+// ends; take copies with CAPTURE_STATS_read from the other core.  Line
+// periods are core0 SysTick cycles, timed HSYNC rise to HSYNC rise.
+typedef struct capture_stats_t
+{
+    uint32_t sequence;          // odd while a frame is being folded in
+    uint32_t frames;            // frames captured to the last line
+    uint32_t frames_aborted;    // HSYNC stopped -- resynced on the next VSYNC
+    uint32_t short_lines;       // pixel clock stopped before the end of a line
+    uint32_t late_edges;        // pixel clock had already risen when capture came to wait for it
+    uint32_t frame_us;          // VSYNC to VSYNC, last frame
+    uint32_t line_cycles_min;   // last frame
+    uint32_t line_cycles_max;   // last frame -- jitter is max - min
+    uint16_t pixels_min;        // fewest pixel clocks seen on a line of the last frame
+#ifdef CAPTURE_SLACK_STATS
+    uint32_t slack_frame;       // fewest spare spins between pixel clock edges, last frame
+    uint32_t slack_min;         // ... and since power on
+#endif
+} capture_stats_t;
+
+extern volatile capture_stats_t capture_stats;
+
+// Copies the stats, retrying if a frame was folded in during the copy
+static inline void CAPTURE_STATS_read(capture_stats_t* stats)
+{
+    uint32_t sequence;
+    do
+    {
+        sequence = capture_stats.sequence;
+        __dmb();
+        *stats = capture_stats;
+        __dmb();
+    } while ((sequence & 1) || sequence != capture_stats.sequence);
+}
+
+#endif // CAPTURE_STATS_H
@@ -0,0 +1,43 @@
+#ifndef DOT_MATRIX_H
+#define DOT_MATRIX_H
+
+#include "pico/stdlib.h"
+#include "colors.h"
+
+// At 3x each DMG pixel is a 3x3 block on the panel.  The dot matrix mode
+// (DOT_MATRIX_MODE, scanvideo at xscale=1, yscale=1) draws each block from a
+// precomputed template:  two lit pixels and a darker gap pixel, with every
+// third output line drawn as a gap row.  Templates are rebuilt together with
+// the scheme LUTs, so a line costs one template load per DMG pixel.
+#define DOT_MATRIX_TOKENS       (3)
+
+typedef enum
+{
+    DOT_ROW_PIXEL = 0,
+    DOT_ROW_GAP,
+    DOT_ROW_KINDS
+} dot_row_t;
+
+typedef uint16_t dot_template_t[DOT_MATRIX_TOKENS];
+
+void build_dot_matrix_templates(void);
+const dot_template_t* get_dot_matrix_templates(uint8_t region, uint8_t phase, uint8_t sub_row);
+bool get_dot_grid_enabled(void);
+void set_dot_grid_enabled(bool enabled);
+
+// Game pixels for one output line.  Even and odd pixels use templates for
+// different dither phases.
+static inline uint16_t* dot_matrix_span(uint16_t* p16, const uint8_t* pixels, uint16_t x, uint16_t count, const dot_template_t* const templates[2])
+{
+    const uint8_t* end = pixels + count;
+    while (pixels < end)
+    {
+        const uint16_t* t = templates[x++ & 1][*pixels++];
+        *p16++ = t[0];
+        *p16++ = t[1];
+        *p16++ = t[2];
+    }
+    return p16;
+}
+
+#endif // DOT_MATRIX_H
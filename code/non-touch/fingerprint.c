@@ -0,0 +1,137 @@
+#include "fingerprint.h"
+#include "colors.h"
+#include "known_titles.h"
+#include "settings.h"
+
+#define FNV_OFFSET          (2166136261u)
+#define FNV_PRIME           (16777619u)
+#define STABLE_PASSES       (2)
+#define BUCKET_SHIFT        (24)
+#define BUCKETS             (256)
+
+typedef struct known_title_t
+{
+    uint32_t fingerprint;
+    int8_t scheme;
+} known_title_t;
+
+#define KNOWN_TITLE_ENTRY(fingerprint, scheme)  { fingerprint, scheme },
+
+// the sentinel keeps the table from being empty and ends the last bucket
+static const known_title_t known_titles[] = 
+{
+    KNOWN_TITLE_TABLE(KNOWN_TITLE_ENTRY)
+    { UINT32_MAX, FINGERPRINT_UNKNOWN }
+};
+
+#define KNOWN_TITLE_COUNT   (sizeof(known_titles) / sizeof(known_titles[0]) - 1)
+
+// First table entry for each top byte of the fingerprint
+static uint16_t bucket_start[BUCKETS + 1];
+
+static uint16_t frames_left = 0;
+static uint8_t tile_row = 0;
+static uint32_t hash;
+static uint8_t first_shade;
+static bool uniform;
+static uint32_t previous_hash;
+static uint8_t stable_passes;
+static volatile bool reported = true;
+static volatile uint32_t stable_hash;
+
+void FINGERPRINT_init(void)
+{
+    uint16_t entry = 0;
+    for (int bucket = 0; bucket <= BUCKETS; bucket++)
+    {
+        while (entry < KNOWN_TITLE_COUNT && (known_titles[entry].fingerprint >> BUCKET_SHIFT) < (uint32_t)bucket)
+            entry++;
+        bucket_start[bucket] = entry;
+    }
+
+    // a new window starts from nothing seen
+    hash = FNV_OFFSET;
+    uniform = true;
+    tile_row = 0;
+    previous_hash = 0;
+    stable_passes = 0;
+    reported = true;
+    frames_left = FINGERPRINT_WINDOW_FRAMES;
+}
+
+// Hashes the next FINGERPRINT_TILE_ROWS_PER_FRAME tile rows -- 120 loads
+// and multiplies, so it fits in VBLANK after the capture loop.
+void __not_in_flash_func(FINGERPRINT_capture_frame)(const uint8_t* framebuffer, orientation_t orientation)
+{
+    if (frames_left == 0)
+        return;
+    frames_left--;
+
+    uint8_t last_row = tile_row + FINGERPRINT_TILE_ROWS_PER_FRAME;
+    for (; tile_row < last_row && tile_row < FINGERPRINT_TILES_Y; tile_row++)
+    {
+        uint8_t y = (tile_row * 8) + 4;
+        for (uint8_t tile_x = 0; tile_x < FINGERPRINT_TILES_X; tile_x++)
+        {
+            uint8_t x = (tile_x * 8) + 4;
+            int32_t index = orientation_index(orientation, x, y, FINGERPRINT_TILES_X * 8, FINGERPRINT_TILES_Y * 8);
+            uint8_t shade = SHADE_CURRENT(framebuffer[index]);
+
+            if (tile_row == 0 && tile_x == 0)
+                first_shade = shade;
+            uniform &= (shade == first_shade);
+            hash = (hash ^ shade) * FNV_PRIME;
+        }
+    }
+
+    if (tile_row < FINGERPRINT_TILES_Y)
+        return;
+
+    // blank screens between scenes are never reported
+    if (!uniform && hash == previous_hash)
+    {
+        if (stable_passes < STABLE_PASSES && ++stable_passes == STABLE_PASSES)
+        {
+            stable_hash = hash != SETTINGS_DEFAULT_GAME ? hash : hash + 1;
+            reported = false;
+        }
+    }
+    else
+    {
+        stable_passes = 0;
+    }
+
+    previous_hash = hash;
+    hash = FNV_OFFSET;
+    uniform = true;
+    tile_row = 0;
+}
+
+// True once for each newly stable screen
+bool FINGERPRINT_poll(uint32_t* fingerprint)
+{
+    if (reported)
+        return false;
+
+    *fingerprint = stable_hash;
+    reported = true;
+    return true;
+}
+
+// Scheme for a known title screen, FINGERPRINT_SKIP for a screen that is
+// not a title, or FINGERPRINT_UNKNOWN
+int FINGERPRINT_lookup(uint32_t fingerprint)
+{
+    uint32_t bucket = fingerprint >> BUCKET_SHIFT;
+    for (uint16_t entry = bucket_start[bucket]; entry < bucket_start[bucket + 1]; entry++)
+    {
+        if (known_titles[entry].fingerprint == fingerprint)
+            return known_titles[entry].scheme;
+    }
+    return FINGERPRINT_UNKNOWN;
+}
+
+void FINGERPRINT_stop(void)
+{
+    frames_left = 0;
+}
@@ -0,0 +1,25 @@
+#ifndef FINGERPRINT_H
+#define FINGERPRINT_H
+
+#include "pico/stdlib.h"
+#include "orientation.h"
+
+// Title screen fingerprinting.  For the first FINGERPRINT_WINDOW_FRAMES
+// captured frames, the center pixel of every 8x8 tile is hashed, a few tile
+// rows per frame during VBLANK.  Tiles are read in DMG order, so the hash
+// is the same in every orientation.  A hash that repeats on consecutive
+// passes is a stable screen and is reported to the main loop.
+#define FINGERPRINT_TILES_X             (20)
+#define FINGERPRINT_TILES_Y             (18)
+#define FINGERPRINT_TILE_ROWS_PER_FRAME (6)
+#define FINGERPRINT_WINDOW_FRAMES       (60 * 30)
+#define FINGERPRINT_UNKNOWN             (-1)
+#define FINGERPRINT_SKIP                (-2)    // a screen every game shows, e.g. the boot logo
+
+void FINGERPRINT_init(void);
+void FINGERPRINT_capture_frame(const uint8_t* framebuffer, orientation_t orientation);
+bool FINGERPRINT_poll(uint32_t* fingerprint);
+int FINGERPRINT_lookup(uint32_t fingerprint);
+void FINGERPRINT_stop(void);
+
+#endif // FINGERPRINT_H
@@ -0,0 +1,73 @@
+#ifndef GAME_SPAN_H
+#define GAME_SPAN_H
+
+#include "pico/stdlib.h"
+#include "hardware/interp.h"
+
+// The scheme LUT lookup of the 3x (not DOT_MATRIX_MODE) renderer, run by
+// core1 for every game pixel.
+
+// Core1 interpolator lanes pick bytes 0 and 1 (interp0) and 2 and 3
+// (interp1) out of a framebuffer word shifted up by one, leaving each shade
+// pair as a uint16_t offset to add to its LUT base.  Lane 1 reads lane 0's
+// accumulator, so one write feeds both lanes.
+static inline void init_render_interp(void)
+{
+    for (uint lane = 0; lane < 2; lane++)
+    {
+        interp_config config = interp_default_config();
+        interp_config_set_mask(&config, 1, 4);
+        interp_config_set_cross_input(&config, lane == 1);
+
+        interp_config_set_shift(&config, lane * 8);
+        interp_set_config(interp0, lane, &config);
+
+        interp_config_set_shift(&config, 16 + (lane * 8));
+        interp_set_config(interp1, lane, &config);
+    }
+}
+
+// Game pixels for one output line.  Even and odd pixels use LUTs for
+// different dither phases.  Aligned groups of four pixels are looked up
+// through the core1 interpolators (see init_render_interp):  the word is
+// written once to each and the four lanes return the LUT entry addresses.
+// Rows start on a word, so the first pixel of each group is even.
+static inline uint16_t* game_span(uint16_t* p16, const uint8_t* pixels, uint16_t x, uint16_t count, const uint16_t* const scheme_lut[2])
+{
+    const uint8_t* end = pixels + count;
+    while (pixels < end && ((uintptr_t)pixels & 3))
+    {
+        *p16++ = scheme_lut[x++ & 1][*pixels++];
+    }
+
+    const uint8_t* words_end = pixels + ((end - pixels) & ~3);
+    if (pixels < words_end)
+    {
+        interp_set_base(interp0, 0, (uintptr_t)scheme_lut[0]);
+        interp_set_base(interp0, 1, (uintptr_t)scheme_lut[1]);
+        interp_set_base(interp1, 0, (uintptr_t)scheme_lut[0]);
+        interp_set_base(interp1, 1, (uintptr_t)scheme_lut[1]);
+    }
+    while (pixels < words_end)
+    {
+        // shade pairs are below 16, so the shift loses nothing and turns
+        // each masked byte into a uint16_t offset
+        uint32_t quad = *(const uint32_t*)pixels << 1;
+        pixels += 4;
+        interp_set_accumulator(interp0, 0, quad);
+        interp_set_accumulator(interp1, 0, quad);
+        p16[0] = *(const uint16_t*)interp_peek_lane_result(interp0, 0);
+        p16[1] = *(const uint16_t*)interp_peek_lane_result(interp0, 1);
+        p16[2] = *(const uint16_t*)interp_peek_lane_result(interp1, 0);
+        p16[3] = *(const uint16_t*)interp_peek_lane_result(interp1, 1);
+        p16 += 4;
+    }
+
+    while (pixels < end)
+    {
+        *p16++ = scheme_lut[x++ & 1][*pixels++];
+    }
+    return p16;
+}
+
+#endif // GAME_SPAN_H
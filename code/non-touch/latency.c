@@ -0,0 +1,194 @@
+#include "latency.h"
+
+#ifdef LATENCY_ENABLED
+
+#include <string.h>
+#include "hardware/sync.h"
+#include "telemetry.h"
+
+typedef struct stage_stats_t
+{
+    uint32_t samples;
+    uint32_t worst;
+    uint64_t total;
+    uint32_t bins[LATENCY_BINS];
+} stage_stats_t;
+
+_Static_assert(TELEMETRY_LATENCY_STAGES == LATENCY_STAGE_TOTAL, "telemetry_latency_t stages");
+
+latency_probe_t latency_probe;
+
+// Only touched by core0 outside interrupts
+static stage_stats_t stage_stats[LATENCY_STAGES];
+static volatile uint32_t timeouts;
+
+static inline void set_state(latency_state_t state)
+{
+    __dmb();    // the stamps before the state that hands them on
+    latency_probe.state = state;
+}
+
+// A press of buttons.  read_by_game when it was seen at the game's read
+// of the joypad matrix, rather than reported by the touch panel.
+void __not_in_flash_func(LATENCY_input)(uint16_t buttons, bool read_by_game)
+{
+    if (latency_probe.state != LATENCY_IDLE || buttons == 0)
+        return;
+
+    latency_probe.buttons = buttons;
+    latency_probe.input_us = time_us_32();
+    latency_probe.read_us = latency_probe.input_us;
+    set_state(read_by_game ? LATENCY_READ : LATENCY_INPUT);
+}
+
+// The game read the joypad matrix group holding buttons, and was given
+// their current states
+void __not_in_flash_func(LATENCY_game_read)(uint16_t buttons)
+{
+    if (latency_probe.state != LATENCY_INPUT || (buttons & latency_probe.buttons) == 0)
+        return;
+
+    latency_probe.read_us = time_us_32();
+    set_state(LATENCY_READ);
+}
+
+// Offset of the first pixel whose shade is not the one it had last frame,
+// or -1.  Each byte has the current shade in bits 0-1 and the previous in
+// bits 2-3, so a word compares four pixels.  About 100us at 240MHz for a
+// frame that is all the same, and it only runs while a press is waiting
+// for an answer.
+static int32_t __not_in_flash_func(first_change)(const uint8_t* framebuffer, uint32_t length)
+{
+    const uint32_t* words = (const uint32_t*)framebuffer;
+    for (uint32_t i = 0; i < length / 4; i++)
+    {
+        uint32_t word = words[i];
+        if ((word ^ (word >> 2)) & 0x03030303)
+            return (int32_t)(i * 4);
+    }
+    return -1;
+}
+
+// Called by the capture interrupt after each complete frame.  Frames that
+// began before the game read the press can't be its answer.
+void __not_in_flash_func(LATENCY_frame_captured)(uint32_t vsync_us, const uint8_t* framebuffer, uint16_t width, uint32_t length)
+{
+    latency_state_t state = latency_probe.state;
+    if (state != LATENCY_INPUT && state != LATENCY_READ)
+        return;
+
+    if (time_us_32() - latency_probe.input_us > LATENCY_TIMEOUT_US)
+    {
+        timeouts++;
+        set_state(LATENCY_IDLE);
+        return;
+    }
+
+    if (state != LATENCY_READ || (int32_t)(vsync_us - latency_probe.read_us) < 0)
+        return;
+
+    int32_t index = first_change(framebuffer, length);
+    if (index < 0)
+        return;
+
+    latency_probe.line = (uint16_t)(index / width);
+    latency_probe.vsync_us = vsync_us;
+    latency_probe.captured_us = time_us_32();
+    set_state(LATENCY_CAPTURED);
+}
+
+// Core1 has rendered the line -- see LATENCY_render_line
+void __not_in_flash_func(LATENCY_rendered)(void)
+{
+    latency_probe.rendered_us = time_us_32();
+    set_state(LATENCY_DONE);
+}
+
+static void add_sample(latency_stage_t stage, uint32_t us)
+{
+    stage_stats_t* stats = &stage_stats[stage];
+    uint32_t bin = us / LATENCY_BIN_US;
+    stats->bins[bin < LATENCY_BINS ? bin : LATENCY_BINS - 1]++;
+    stats->samples++;
+    stats->total += us;
+    if (us > stats->worst)
+        stats->worst = us;
+}
+
+// Bins a finished measurement and frees the probe for the next press.
+// Runs in the core0 main loop.
+void LATENCY_tasks(void)
+{
+    latency_state_t state = latency_probe.state;
+
+    // a change whose line core1 does not draw in time (paused for a flash
+    // write) times out like one never seen
+    if (state == LATENCY_CAPTURED && time_us_32() - latency_probe.input_us > LATENCY_TIMEOUT_US)
+    {
+        timeouts++;
+        set_state(LATENCY_IDLE);
+        return;
+    }
+
+    if (state != LATENCY_DONE)
+        return;
+
+    telemetry_latency_t record =
+    {
+        .time_us = latency_probe.input_us,
+        .buttons = latency_probe.buttons,
+        .stage_us =
+        {
+            [LATENCY_STAGE_TOUCH_POLL] = latency_probe.read_us - latency_probe.input_us,
+            [LATENCY_STAGE_GAME] = latency_probe.vsync_us - latency_probe.read_us,
+            [LATENCY_STAGE_CAPTURE] = latency_probe.captured_us - latency_probe.vsync_us,
+            [LATENCY_STAGE_RENDER] = latency_probe.rendered_us - latency_probe.captured_us,
+        },
+    };
+    set_state(LATENCY_IDLE);
+
+    for (int stage = 0; stage < LATENCY_STAGE_TOTAL; stage++)
+        add_sample(stage, record.stage_us[stage]);
+    add_sample(LATENCY_STAGE_TOTAL, latency_probe.rendered_us - latency_probe.input_us);
+    TELEMETRY_send(TELEMETRY_LATENCY, &record, sizeof(record));
+}
+
+void LATENCY_get(latency_stage_t stage, latency_summary_t* summary)
+{
+    const stage_stats_t* stats = &stage_stats[stage];
+    uint32_t samples = stats->samples;
+
+    summary->samples = samples;
+    summary->worst_us = stats->worst;
+    summary->mean_us = samples ? (uint32_t)(stats->total / samples) : 0;
+    summary->p50_us = 0;
+    summary->p99_us = 0;
+    summary->timeouts = timeouts;
+
+    uint32_t seen = 0;
+    for (int bin = 0; bin < LATENCY_BINS && samples; bin++)
+    {
+        seen += stats->bins[bin];
+        uint32_t edge = (bin == LATENCY_BINS - 1) ? stats->worst : (uint32_t)(bin + 1) * LATENCY_BIN_US;
+        if (summary->p50_us == 0 && seen * 2 >= samples)
+            summary->p50_us = edge;
+        if (seen * 100 >= samples * 99)
+        {
+            summary->p99_us = edge;
+            break;
+        }
+    }
+    summary->p50_us = summary->p50_us > stats->worst ? stats->worst : summary->p50_us;
+    summary->p99_us = summary->p99_us > stats->worst ? stats->worst : summary->p99_us;
+}
+
+// Also drops a press being measured, so nothing from before the reset is
+// binned after it
+void LATENCY_reset(void)
+{
+    set_state(LATENCY_IDLE);
+    memset(stage_stats, 0, sizeof(stage_stats));
+    timeouts = 0;
+}
+
+#endif // LATENCY_ENABLED
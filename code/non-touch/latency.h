@@ -0,0 +1,102 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "pico/stdlib.h"
+
+// Input to photon latency.  A button press starts a measurement, which
+// then follows it through the chain, one stage at a time:
+//
+//   touch poll  touch reported by TOUCH_tasks to the game reading the
+//               joypad matrix and getting the new state (0 for the joypad
+//               build, where the press is first seen at that read)
+//   game        that read to the VSYNC of the first frame that differs
+//               from the one before
+//   capture     that VSYNC to the end of the frame's capture
+//   render      end of capture to core1 rendering the first output line
+//               the difference is on
+//
+// One press is measured at a time; presses while a measurement is under
+// way are ignored.  Measure on a screen that only changes in answer to the
+// buttons -- a menu cursor, say -- or an animation will be taken for the
+// response.
+//
+// Enabled with GAMEBOY_XL_LATENCY; without it the calls are empty.  The
+// histograms are kept on core0 and each measurement is also sent as a
+// telemetry record (see telemetry.h).
+#define LATENCY_BIN_US          (1000)
+#define LATENCY_BINS            (64)        // last bin also holds anything slower
+#define LATENCY_TIMEOUT_US      (500000)    // no change on screen by then -- not counted
+
+typedef enum
+{
+    LATENCY_STAGE_TOUCH_POLL = 0,
+    LATENCY_STAGE_GAME,
+    LATENCY_STAGE_CAPTURE,
+    LATENCY_STAGE_RENDER,
+    LATENCY_STAGE_TOTAL,
+    LATENCY_STAGES
+} latency_stage_t;
+
+typedef enum
+{
+    LATENCY_IDLE = 0,
+    LATENCY_INPUT,          // touch seen, game has not read it yet
+    LATENCY_READ,           // game has read it, waiting for a frame that changes
+    LATENCY_CAPTURED,       // changed frame captured, waiting for its line to render
+    LATENCY_DONE,           // waiting for LATENCY_tasks to bin it
+} latency_state_t;
+
+typedef struct latency_summary_t
+{
+    uint32_t samples;
+    uint32_t mean_us;
+    uint32_t p50_us;        // upper edge of the bin
+    uint32_t p99_us;        // upper edge of the bin
+    uint32_t worst_us;
+    uint32_t timeouts;      // presses with no change on screen, all stages
+} latency_summary_t;
+
+#ifdef LATENCY_ENABLED
+
+typedef struct latency_probe_t
+{
+    volatile latency_state_t state;
+    uint16_t buttons;       // pressed, bit per controller_button_t
+    uint16_t line;          // game window line the change is first on
+    uint32_t input_us;
+    uint32_t read_us;
+    uint32_t vsync_us;
+    uint32_t captured_us;
+    uint32_t rendered_us;
+} latency_probe_t;
+
+extern latency_probe_t latency_probe;
+
+void LATENCY_input(uint16_t buttons, bool read_by_game);
+void LATENCY_game_read(uint16_t buttons);
+void LATENCY_frame_captured(uint32_t vsync_us, const uint8_t* framebuffer, uint16_t width, uint32_t length);
+void LATENCY_rendered(void);
+void LATENCY_tasks(void);
+void LATENCY_get(latency_stage_t stage, latency_summary_t* summary);
+void LATENCY_reset(void);
+
+// Called by core1 for every game line it renders
+static inline __attribute__((always_inline)) void LATENCY_render_line(uint16_t line)
+{
+    if (latency_probe.state == LATENCY_CAPTURED && line == latency_probe.line)
+        LATENCY_rendered();
+}
+
+#else
+
+static inline void LATENCY_input(uint16_t buttons, bool read_by_game) {}
+static inline void LATENCY_game_read(uint16_t buttons) {}
+static inline void LATENCY_frame_captured(uint32_t vsync_us, const uint8_t* framebuffer, uint16_t width, uint32_t length) {}
+static inline void LATENCY_render_line(uint16_t line) {}
+static inline void LATENCY_tasks(void) {}
+static inline void LATENCY_get(latency_stage_t stage, latency_summary_t* summary) { *summary = (latency_summary_t){ 0 }; }
+static inline void LATENCY_reset(void) {}
+
+#endif // LATENCY_ENABLED
+
+#endif // LATENCY_H
@@ -0,0 +1,59 @@
+#ifndef ORIENTATION_H
+#define ORIENTATION_H
+
+#include "pico/stdlib.h"
+
+// How the game (and OSD) is laid out on the panel.  Buffers are stored in
+// output order -- one row per output line -- so rendering is the same for
+// every orientation and only capture and OSD drawing map coordinates.
+// Rotations are clockwise; mirrored modes also flip each output line.
+#define ORIENTATION_TABLE(X) \
+    X(ORIENTATION_0,            "0") \
+    X(ORIENTATION_90,           "90") \
+    X(ORIENTATION_180,          "180") \
+    X(ORIENTATION_270,          "270") \
+    X(ORIENTATION_0_MIRRORED,   "0 MIRROR") \
+    X(ORIENTATION_90_MIRRORED,  "90 MIRROR") \
+    X(ORIENTATION_180_MIRRORED, "180 MIRROR") \
+    X(ORIENTATION_270_MIRRORED, "270 MIRROR")
+
+#define ORIENTATION_ENUM(name, label)   name,
+
+typedef enum
+{
+    ORIENTATION_TABLE(ORIENTATION_ENUM)
+    ORIENTATION_COUNT
+} orientation_t;
+
+#define ORIENTATION_ROTATION(o)     ((o) & 3)
+#define ORIENTATION_IS_SIDEWAYS(o)  (((o) & 1) != 0)        // 90 and 270 swap width and height
+#define ORIENTATION_IS_MIRRORED(o)  ((o) >= ORIENTATION_0_MIRRORED)
+
+// Output line length and line count for a width x height source
+#define ORIENTATION_OUT_WIDTH(o, width, height)     (ORIENTATION_IS_SIDEWAYS(o) ? (height) : (width))
+#define ORIENTATION_OUT_HEIGHT(o, width, height)    (ORIENTATION_IS_SIDEWAYS(o) ? (width) : (height))
+
+// Output buffer index of source pixel (x, y).  Every mode is linear in x
+// and y, so with a constant orientation the compiler reduces this to a
+// base plus fixed x and y steps.
+static inline int32_t orientation_index(orientation_t o, int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    int32_t line;
+    int32_t pos;
+
+    switch (ORIENTATION_ROTATION(o))
+    {
+        case 1:     line = x;               pos = height - 1 - y;   break;
+        case 2:     line = height - 1 - y;  pos = width - 1 - x;    break;
+        case 3:     line = width - 1 - x;   pos = y;                break;
+        default:    line = y;               pos = x;                break;
+    }
+
+    int32_t out_width = ORIENTATION_OUT_WIDTH(o, width, height);
+    if (ORIENTATION_IS_MIRRORED(o))
+        pos = out_width - 1 - pos;
+
+    return pos + (line * out_width);
+}
+
+#endif // ORIENTATION_H
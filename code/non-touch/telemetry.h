@@ -0,0 +1,121 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "pico/stdlib.h"
+
+// Binary telemetry over USB CDC, for pulling stats off a running unit.
+// Records are framed as
+//
+//   0xA5 0x5A  version  type  sequence  length  payload[length]  crc8
+//
+// with the CRC-8 (polynomial 0x07) over version to the end of the payload
+// and the payload little endian.  The sequence counts every record queued,
+// including ones dropped because the ring was full, so a gap shows the
+// loss.  Records are queued in a byte ring and only written out by
+// TELEMETRY_tasks, from the core0 main loop, as far as the transport takes
+// them without blocking.  Everything here must be called from that loop.
+//
+// Enabled with GAMEBOY_XL_TELEMETRY; without it the functions are empty.
+// Read the stream with tools/telemetry_decode.py.  Off the device
+// (PICO_ON_DEVICE is 0) the bytes go to stdout unless TELEMETRY_set_transport
+// points them somewhere else, e.g. a pipe.
+#define TELEMETRY_SYNC0         (0xA5)
+#define TELEMETRY_SYNC1         (0x5A)
+#define TELEMETRY_VERSION       (1)
+#define TELEMETRY_RING_BYTES    (2048)      // power of two
+#define TELEMETRY_PERIOD_US     (1000000)   // capture and render records
+#define TELEMETRY_RENDER_BINS   (48)        // RENDER_STATS_BINS
+#define TELEMETRY_LATENCY_STAGES (4)        // LATENCY_STAGE_TOTAL
+
+typedef enum
+{
+    TELEMETRY_CAPTURE = 1,      // telemetry_capture_t, each period
+    TELEMETRY_RENDER,           // telemetry_render_t, one per line type each period
+    TELEMETRY_BUTTONS,          // telemetry_buttons_t, when the buttons change
+    TELEMETRY_TOUCH,            // telemetry_touch_t, on touch down and up
+    TELEMETRY_LATENCY,          // telemetry_latency_t, per latency measurement
+    TELEMETRY_FINGERPRINT,      // telemetry_fingerprint_t, per stable screen after power on
+} telemetry_type_t;
+
+// capture_stats_t as it stood at time_us
+typedef struct __attribute__((packed)) telemetry_capture_t
+{
+    uint32_t time_us;
+    uint32_t frames;
+    uint32_t frames_aborted;
+    uint32_t short_lines;
+    uint32_t late_edges;
+    uint32_t frame_us;
+    uint32_t line_cycles_min;
+    uint32_t line_cycles_max;
+    uint16_t pixels_min;
+} telemetry_capture_t;
+
+// Scanline render cost of one line type over the last period.  Bin n
+// counts renders of n << bin_shift cycles and up.
+typedef struct __attribute__((packed)) telemetry_render_t
+{
+    uint32_t time_us;
+    uint8_t line_type;          // render_line_type_t
+    uint8_t bin_shift;
+    uint16_t missed;
+    uint16_t bins[TELEMETRY_RENDER_BINS];
+} telemetry_render_t;
+
+typedef struct __attribute__((packed)) telemetry_buttons_t
+{
+    uint32_t time_us;
+    uint16_t pressed;           // bit per controller_button_t
+} telemetry_buttons_t;
+
+typedef struct __attribute__((packed)) telemetry_touch_t
+{
+    uint32_t time_us;
+    uint16_t x;                 // panel pixels
+    uint16_t y;
+    uint8_t down;               // 1 touch down, 0 touch up
+} telemetry_touch_t;
+
+// Stages of one input to photon measurement, see latency.h
+typedef struct __attribute__((packed)) telemetry_latency_t
+{
+    uint32_t time_us;           // of the input
+    uint16_t buttons;           // bit per controller_button_t
+    uint32_t stage_us[TELEMETRY_LATENCY_STAGES];
+} telemetry_latency_t;
+
+// A title screen fingerprint (see fingerprint.h), known or not -- what
+// tools/fingerprint.py --hash adds to known_titles.h
+typedef struct __attribute__((packed)) telemetry_fingerprint_t
+{
+    uint32_t time_us;
+    uint32_t fingerprint;
+    int8_t scheme;              // FINGERPRINT_lookup
+} telemetry_fingerprint_t;
+
+// Writes up to length bytes without blocking and returns how many it took
+typedef size_t (*telemetry_transport_t)(const uint8_t* data, size_t length);
+
+#ifdef TELEMETRY_ENABLED
+
+void TELEMETRY_init(void);
+void TELEMETRY_set_transport(telemetry_transport_t transport);
+bool TELEMETRY_send(telemetry_type_t type, const void* payload, uint8_t length);
+void TELEMETRY_send_buttons(uint16_t pressed);
+void TELEMETRY_send_touch(uint16_t x, uint16_t y, bool down);
+void TELEMETRY_send_fingerprint(uint32_t fingerprint, int scheme);
+void TELEMETRY_tasks(void);
+
+#else
+
+static inline void TELEMETRY_init(void) {}
+static inline void TELEMETRY_set_transport(telemetry_transport_t transport) { (void)transport; }
+static inline bool TELEMETRY_send(telemetry_type_t type, const void* payload, uint8_t length) { return false; }
+static inline void TELEMETRY_send_buttons(uint16_t pressed) {}
+static inline void TELEMETRY_send_touch(uint16_t x, uint16_t y, bool down) {}
+static inline void TELEMETRY_send_fingerprint(uint32_t fingerprint, int scheme) {}
+static inline void TELEMETRY_tasks(void) {}
+
+#endif // TELEMETRY_ENABLED
+
+#endif // TELEMETRY_H
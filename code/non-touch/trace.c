@@ -0,0 +1,16 @@
+#include "trace.h"
+
+#ifdef TRACE_ENABLED
+// In main SRAM -- at 16KB it is bigger than either scratch bank
+trace_buffer_t trace_buffer;
+#endif
+
+// Stamps the layout the decoder checks.  Call before either core traces.
+void TRACE_init(void)
+{
+#ifdef TRACE_ENABLED
+    trace_buffer.magic = TRACE_MAGIC;
+    trace_buffer.version = TRACE_VERSION;
+    trace_buffer.events_per_core = TRACE_EVENTS_PER_CORE;
+#endif
+}
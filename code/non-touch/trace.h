@@ -0,0 +1,105 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+// Event trace for timelines across both cores.  Each core writes its own
+// ring of 8 byte events -- timer microseconds, an event id, the Chrome trace
+// phase and a 16 bit argument -- so the cores never contend.  A slot is
+// claimed and stamped with interrupts held off, so an interrupt tracing on
+// the same core can't take the same slot or stamp out of order.
+//
+// Enabled with GAMEBOY_XL_TRACE; without it the TRACE_ macros compile to
+// nothing.  Dump trace_buffer from the debugger, e.g.
+//   dump binary value trace.bin trace_buffer
+// and convert it with tools/trace_decode.py.  Off the device (PICO_ON_DEVICE
+// is 0) everything is traced as core 0 with no interrupt masking.
+#define TRACE_CORES             (2)
+#define TRACE_EVENTS_PER_CORE   (1024)  // power of two
+#define TRACE_MAGIC             (0x45435254)    // "TRCE"
+#define TRACE_VERSION           (1)
+
+// Ids are the table order, which tools/trace_decode.py reads from here
+#define TRACE_EVENT_TABLE(X) \
+    X(CAPTURE) \
+    X(CAPTURE_LATE_EDGES) \
+    X(VBLANK_WORK) \
+    X(JOYPAD) \
+    X(SCANLINE_WAIT) \
+    X(SCANLINE) \
+    X(RENDER_DEGRADED) \
+    X(COMMAND_CHECK) \
+    X(FLASH_WRITE) \
+    X(TOUCH_DOWN) \
+    X(TOUCH_UP) \
+    X(TOUCH_MOVE)
+
+#define TRACE_EVENT_ID(name)    TRACE_##name,
+typedef enum
+{
+    TRACE_EVENT_TABLE(TRACE_EVENT_ID)
+    TRACE_EVENT_COUNT
+} trace_event_id_t;
+
+typedef struct trace_event_t
+{
+    uint32_t time_us;
+    uint8_t id;
+    char phase;                 // 'B' begin, 'E' end, 'i' instant, 'C' counter
+    uint16_t arg;
+} trace_event_t;
+
+typedef struct trace_ring_t
+{
+    uint32_t head;              // events ever written; the slot is head % TRACE_EVENTS_PER_CORE
+    trace_event_t events[TRACE_EVENTS_PER_CORE];
+} trace_ring_t;
+
+typedef struct trace_buffer_t
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t events_per_core;
+    trace_ring_t rings[TRACE_CORES];
+} trace_buffer_t;
+
+void TRACE_init(void);
+
+#ifdef TRACE_ENABLED
+
+extern trace_buffer_t trace_buffer;
+
+static inline __attribute__((always_inline)) void trace_record(trace_event_id_t id, char phase, uint16_t arg)
+{
+#if PICO_ON_DEVICE
+    trace_ring_t* ring = &trace_buffer.rings[get_core_num()];
+    uint32_t interrupts = save_and_disable_interrupts();
+#else
+    trace_ring_t* ring = &trace_buffer.rings[0];
+#endif
+    trace_event_t* event = &ring->events[ring->head++ & (TRACE_EVENTS_PER_CORE - 1)];
+    event->time_us = time_us_32();
+#if PICO_ON_DEVICE
+    restore_interrupts(interrupts);
+#endif
+    event->id = id;
+    event->phase = phase;
+    event->arg = arg;
+}
+
+#define TRACE_BEGIN(name, arg)      trace_record(TRACE_##name, 'B', (arg))
+#define TRACE_END(name, arg)        trace_record(TRACE_##name, 'E', (arg))
+#define TRACE_INSTANT(name, arg)    trace_record(TRACE_##name, 'i', (arg))
+#define TRACE_COUNTER(name, value)  trace_record(TRACE_##name, 'C', (value))
+
+#else
+
+#define TRACE_BEGIN(name, arg)      ((void)0)
+#define TRACE_END(name, arg)        ((void)0)
+#define TRACE_INSTANT(name, arg)    ((void)0)
+#define TRACE_COUNTER(name, value)  ((void)0)
+
+#endif // TRACE_ENABLED
+
+#endif // TRACE_H
@@ -0,0 +1,15 @@
+# Runs tools/fingerprint.py on the boot logo screen and checks the firmware
+# hashes the screen it wrote the same way:
+#   cmake -DPYTHON=... -DTOOL=... -DTEST=... -DRAW=... -DLOOKUP=... -P fingerprint_test.cmake
+execute_process(COMMAND ${PYTHON} ${TOOL} --raw ${RAW} --boot-logo
+        OUTPUT_VARIABLE fingerprint
+        OUTPUT_STRIP_TRAILING_WHITESPACE
+        RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "fingerprint.py failed")
+endif ()
+
+execute_process(COMMAND ${TEST} ${RAW} ${fingerprint} ${LOOKUP} RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "firmware fingerprint does not match fingerprint.py ${fingerprint}")
+endif ()
@@ -0,0 +1,12 @@
+#ifndef HOST_HARDWARE_I2C_H
+#define HOST_HARDWARE_I2C_H
+
+#include "pico.h"
+
+// Only a handle off the device -- the transfers go to touch_host.c
+typedef struct i2c_inst
+{
+    uint8_t index;
+} i2c_inst_t;
+
+#endif // HOST_HARDWARE_I2C_H
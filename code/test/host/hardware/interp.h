@@ -0,0 +1,58 @@
+#ifndef HOST_HARDWARE_INTERP_H
+#define HOST_HARDWARE_INTERP_H
+
+#include "pico.h"
+
+// A model of the RP2040 interpolator lanes, as far as the renderer uses
+// them:  a lane result is its base plus its input accumulator shifted right
+// and masked, the input being the other lane's accumulator with cross
+// input.  Bases and results are pointer sized here, so LUT addresses work
+// on a 64 bit host; the SDK's are uint32_t.
+typedef struct
+{
+    uint shift;
+    uint mask_lsb;
+    uint mask_msb;
+    bool cross_input;
+} interp_config;
+
+typedef struct
+{
+    uint32_t accum[2];
+    uintptr_t base[2];
+    interp_config lane[2];
+} interp_hw_t;
+
+static interp_hw_t host_interp[2];
+
+#define interp0     (&host_interp[0])
+#define interp1     (&host_interp[1])
+
+static inline interp_config interp_default_config(void)
+{
+    interp_config config = { .shift = 0, .mask_lsb = 0, .mask_msb = 31, .cross_input = false };
+    return config;
+}
+
+static inline void interp_config_set_shift(interp_config* config, uint shift) { config->shift = shift; }
+static inline void interp_config_set_cross_input(interp_config* config, bool cross_input) { config->cross_input = cross_input; }
+
+static inline void interp_config_set_mask(interp_config* config, uint mask_lsb, uint mask_msb)
+{
+    config->mask_lsb = mask_lsb;
+    config->mask_msb = mask_msb;
+}
+
+static inline void interp_set_config(interp_hw_t* interp, uint lane, interp_config* config) { interp->lane[lane] = *config; }
+static inline void interp_set_base(interp_hw_t* interp, uint lane, uintptr_t base) { interp->base[lane] = base; }
+static inline void interp_set_accumulator(interp_hw_t* interp, uint lane, uint32_t value) { interp->accum[lane] = value; }
+
+static inline uintptr_t interp_peek_lane_result(interp_hw_t* interp, uint lane)
+{
+    const interp_config* config = &interp->lane[lane];
+    uint32_t input = interp->accum[config->cross_input ? !lane : lane];
+    uint32_t mask = (uint32_t)((2ull << config->mask_msb) - (1ull << config->mask_lsb));
+    return interp->base[lane] + ((input >> config->shift) & mask);
+}
+
+#endif // HOST_HARDWARE_INTERP_H
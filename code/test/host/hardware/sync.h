@@ -0,0 +1,12 @@
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+#include "pico.h"
+
+// One thread and no interrupts off the device
+#define __dmb()     __asm volatile("" ::: "memory")
+
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t status) { (void)status; }
+
+#endif // HOST_HARDWARE_SYNC_H
@@ -0,0 +1,26 @@
+#ifndef HOST_PICO_H
+#define HOST_PICO_H
+
+// What the modules take from the SDK's pico.h, off the device
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef PICO_ON_DEVICE
+#define PICO_ON_DEVICE 0
+#endif
+
+typedef unsigned int uint;
+
+#define __not_in_flash_func(f)              f
+#define __no_inline_not_in_flash_func(f)    __attribute__((noinline)) f
+#define __time_critical_func(f)             f
+#define __scratch_x(group)
+#define __scratch_y(group)
+#define __not_in_flash(group)
+
+#define count_of(a)                         (sizeof(a) / sizeof((a)[0]))
+
+static inline void tight_loop_contents(void) {}
+
+#endif // HOST_PICO_H
@@ -0,0 +1,15 @@
+#ifndef HOST_PICO_SCANVIDEO_H
+#define HOST_PICO_SCANVIDEO_H
+
+#include "pico.h"
+
+// The RGB222 token layout the firmware configures (PICO_SCANVIDEO_DPI_PIXEL_*
+// in code/*/CMakeLists.txt)
+#define PICO_SCANVIDEO_PIXEL_RSHIFT 4
+#define PICO_SCANVIDEO_PIXEL_GSHIFT 2
+#define PICO_SCANVIDEO_PIXEL_BSHIFT 0
+#define PICO_SCANVIDEO_PIXEL_RCOUNT 2
+#define PICO_SCANVIDEO_PIXEL_GCOUNT 2
+#define PICO_SCANVIDEO_PIXEL_BCOUNT 2
+
+#endif // HOST_PICO_SCANVIDEO_H
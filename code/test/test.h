@@ -0,0 +1,32 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+// CHECK keeps going after a failure so one run shows them all; a test's
+// main returns TEST_RESULT for ctest
+static int test_failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) \
+        { \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQUAL(actual, expected) \
+    do { \
+        long long actual_ = (long long)(actual); \
+        long long expected_ = (long long)(expected); \
+        if (actual_ != expected_) \
+        { \
+            printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, actual_, expected_); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define TEST_RESULT     (test_failures == 0 ? 0 : 1)
+
+#endif // TEST_H
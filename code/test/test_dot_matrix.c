@@ -0,0 +1,143 @@
+// Golden frames of the dot matrix mode:  a screen holding every shade pair
+// is drawn the way single_scanline does in DOT_MATRIX_MODE, one
+// dot_matrix_span per output line, and has to match the 3x3 blocks built
+// straight from the scheme colors and the frame recorded for it.  A
+// deliberate change to the schemes or the quantizer moves the recorded
+// CRCs; the failure prints the new ones.
+#include <string.h>
+#include "test.h"
+#include "dot_matrix.h"
+
+#define DMG_WIDTH       (160)
+#define DMG_LINES       (144)
+#define OUT_WIDTH       (DMG_WIDTH * DOT_MATRIX_TOKENS)
+#define OUT_LINES       (DMG_LINES * DOT_MATRIX_TOKENS)
+#define REGION_FIRST    (48)    // region 1 covers the middle third
+#define REGION_LAST     (95)
+
+static uint8_t framebuffer[DMG_LINES][DMG_WIDTH];
+static uint16_t frame_tokens[OUT_LINES][OUT_WIDTH];
+
+// The ambient border is not drawn here
+void build_ambient_lut(void)
+{
+}
+
+static uint8_t line_region(int line_index)
+{
+    return (line_index >= REGION_FIRST && line_index <= REGION_LAST) ? 1 : 0;
+}
+
+static void render_frame(uint16_t frame)
+{
+    for (int line = 0; line < OUT_LINES; line++)
+    {
+        uint8_t line_index = line / DOT_MATRIX_TOKENS;
+        uint8_t sub_row = line % DOT_MATRIX_TOKENS;
+        uint8_t region = line_region(line_index);
+        const dot_template_t* templates[2] =
+        {
+            get_dot_matrix_templates(region, FRC_PHASE(0, line_index, frame), sub_row),
+            get_dot_matrix_templates(region, FRC_PHASE(1, line_index, frame), sub_row)
+        };
+        uint16_t* end = dot_matrix_span(frame_tokens[line], framebuffer[line_index], 0, DMG_WIDTH, templates);
+        CHECK(end == frame_tokens[line] + OUT_WIDTH);
+    }
+}
+
+// Every block against its lit and gap tokens; returns the blocks that differ
+static int check_blocks(uint16_t frame)
+{
+    int wrong = 0;
+    for (int line = 0; line < OUT_LINES; line++)
+    {
+        uint8_t line_index = line / DOT_MATRIX_TOKENS;
+        bool gap_row = (line % DOT_MATRIX_TOKENS) == DOT_MATRIX_TOKENS - 1;
+        uint8_t region = line_region(line_index);
+
+        for (int x = 0; x < DMG_WIDTH; x++)
+        {
+            uint8_t pixel = framebuffer[line_index][x];
+            uint8_t phase = FRC_PHASE(x, line_index, frame);
+            uint16_t lit = get_region_lut(region, phase)[pixel];
+            uint16_t gap = lit;
+            if (get_dot_grid_enabled())
+                gap = rgb888_to_scheme_token((get_region_pixel_color(region, pixel) >> 1) & 0x7F7F7F, phase);
+
+            const uint16_t* block = &frame_tokens[line][x * DOT_MATRIX_TOKENS];
+            if (block[0] != (gap_row ? gap : lit) || block[1] != (gap_row ? gap : lit) || block[2] != gap)
+                wrong++;
+        }
+    }
+    return wrong;
+}
+
+// CRC-32 of the tokens, little endian
+static uint32_t frame_crc(void)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    const uint16_t* token = &frame_tokens[0][0];
+    for (int i = 0; i < OUT_LINES * OUT_WIDTH; i++, token++)
+    {
+        uint8_t bytes[2] = { *token & 0xFF, *token >> 8 };
+        for (int b = 0; b < 2; b++)
+        {
+            crc ^= bytes[b];
+            for (int bit = 0; bit < 8; bit++)
+                crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+static void check_frame(const char* name, uint16_t frame, uint32_t golden)
+{
+    render_frame(frame);
+    int wrong = check_blocks(frame);
+    uint32_t crc = frame_crc();
+    if (wrong != 0 || crc != golden)
+        printf("%s, frame %u: %d blocks wrong, crc 0x%08X (golden 0x%08X)\n", name, frame, wrong, crc, golden);
+    CHECK_EQUAL(wrong, 0);
+    CHECK_EQUAL(crc, golden);
+}
+
+int main(void)
+{
+    // every (previous, current) pair on every line, shifted so neighbouring
+    // lines differ
+    for (int y = 0; y < DMG_LINES; y++)
+    {
+        for (int x = 0; x < DMG_WIDTH; x++)
+            framebuffer[y][x] = (x + y) % SCHEME_LUT_SIZE;
+    }
+
+    palette_region_t regions[PALETTE_REGIONS - 1] =
+    {
+        { .scheme = SCHEME_BLACK_AND_WHITE + 1, .first_line = REGION_FIRST, .last_line = REGION_LAST },
+        { .scheme = PALETTE_REGION_OFF }
+    };
+    set_palette(SCHEME_BLACK_AND_WHITE, regions);
+
+    check_frame("grid", 0, 0x67D19391);
+
+    set_dot_grid_enabled(false);
+    check_frame("no grid", 0, 0xE79F3443);
+    set_dot_grid_enabled(true);
+
+    // with dither and blending the phases, and so the frames, differ
+    set_dither_enabled(true);
+    change_blend_level(1);
+    check_frame("dither", 0, 0xFAF9D011);
+    check_frame("dither", 1, 0x94A2B69F);
+
+    // a rebuild goes to the other buffer; the templates core1 may be
+    // drawing from stay as they were until it has moved on
+    const dot_template_t* drawn = get_dot_matrix_templates(0, 0, 0);
+    dot_template_t before[SCHEME_LUT_SIZE];
+    memcpy(before, drawn, sizeof(before));
+    set_dot_grid_enabled(false);
+    CHECK(get_dot_matrix_templates(0, 0, 0) != drawn);
+    CHECK(memcmp(before, drawn, sizeof(before)) == 0);
+
+    return TEST_RESULT;
+}
@@ -0,0 +1,82 @@
+// FINGERPRINT_capture_frame against tools/fingerprint.py:  the screen the
+// tool hashed (its --raw output) is captured in every orientation, and the
+// firmware has to report the tool's fingerprint and find it in
+// known_titles.h as expected.
+//
+// usage: test_fingerprint shades.bin fingerprint lookup
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "fingerprint.h"
+#include "colors.h"
+
+#define SCREEN_WIDTH    (FINGERPRINT_TILES_X * 8)
+#define SCREEN_HEIGHT   (FINGERPRINT_TILES_Y * 8)
+#define PASS_FRAMES     ((FINGERPRINT_TILES_Y + FINGERPRINT_TILE_ROWS_PER_FRAME - 1) / FINGERPRINT_TILE_ROWS_PER_FRAME)
+
+static uint8_t screen[SCREEN_HEIGHT][SCREEN_WIDTH];
+static uint8_t framebuffer[SCREEN_WIDTH * SCREEN_HEIGHT];
+
+// Frames of the screen in orientation until one is reported, or 0
+static int frames_to_report(orientation_t orientation, uint32_t* fingerprint)
+{
+    FINGERPRINT_init();
+    for (int frame = 1; frame <= 10 * PASS_FRAMES; frame++)
+    {
+        FINGERPRINT_capture_frame(framebuffer, orientation);
+        if (FINGERPRINT_poll(fingerprint))
+            return frame;
+    }
+    return 0;
+}
+
+static void capture_screen(orientation_t orientation)
+{
+    for (int y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        for (int x = 0; x < SCREEN_WIDTH; x++)
+        {
+            // the shade before is there too, and must not count
+            uint8_t previous = 3 - screen[y][x];
+            framebuffer[orientation_index(orientation, x, y, SCREEN_WIDTH, SCREEN_HEIGHT)] = SHADE_PUSH(previous, screen[y][x]);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 4)
+    {
+        printf("usage: test_fingerprint shades.bin fingerprint lookup\n");
+        return 2;
+    }
+
+    FILE* f = fopen(argv[1], "rb");
+    CHECK(f != NULL);
+    if (f == NULL)
+        return TEST_RESULT;
+    CHECK_EQUAL(fread(screen, 1, sizeof(screen), f), sizeof(screen));
+    fclose(f);
+    uint32_t expected = strtoul(argv[2], NULL, 16);
+    int lookup = atoi(argv[3]);
+
+    for (orientation_t orientation = 0; orientation < ORIENTATION_COUNT; orientation++)
+    {
+        uint32_t fingerprint = 0;
+        capture_screen(orientation);
+
+        // reported once two passes have hashed the same as the first
+        CHECK_EQUAL(frames_to_report(orientation, &fingerprint), 3 * PASS_FRAMES);
+        CHECK_EQUAL(fingerprint, expected);
+        CHECK_EQUAL(FINGERPRINT_lookup(fingerprint), lookup);
+        CHECK(!FINGERPRINT_poll(&fingerprint));
+    }
+
+    // a blank screen between scenes is never reported
+    uint32_t fingerprint;
+    memset(screen, 2, sizeof(screen));
+    capture_screen(ORIENTATION_0);
+    CHECK_EQUAL(frames_to_report(ORIENTATION_0, &fingerprint), 0);
+
+    return TEST_RESULT;
+}
@@ -0,0 +1,123 @@
+// GT911 driver (touch.c) against the register stand-in (touch_host.c):
+// scans posted with TOUCH_host_report reach the callbacks through
+// TOUCH_tasks, and a scan the driver cannot read is dropped by the part.
+#include <string.h>
+#include "test.h"
+#include "touch.h"
+
+typedef struct touch_event_t
+{
+    char kind;          // 'd'own, 'm'ove, 'u'p
+    uint8_t id;
+    uint16_t x;
+    uint16_t y;
+} touch_event_t;
+
+static touch_event_t events[32];
+static int event_count;
+static i2c_inst_t i2c = { 0 };
+
+static void record(char kind, uint8_t id, uint16_t x, uint16_t y)
+{
+    if (event_count < (int)count_of(events))
+        events[event_count] = (touch_event_t){ kind, id, x, y };
+    event_count++;
+}
+
+static void touchdown(uint8_t id, uint16_t x, uint16_t y) { record('d', id, x, y); }
+static void touchmove(uint8_t id, uint16_t x, uint16_t y) { record('m', id, x, y); }
+static void touchup(uint8_t id, uint16_t x, uint16_t y) { record('u', id, x, y); }
+
+static void check_event(int index, char kind, uint8_t id, uint16_t x, uint16_t y)
+{
+    CHECK(index < event_count);
+    if (index >= event_count)
+        return;
+    CHECK_EQUAL(events[index].kind, kind);
+    CHECK_EQUAL(events[index].id, id);
+    CHECK_EQUAL(events[index].x, x);
+    CHECK_EQUAL(events[index].y, y);
+}
+
+static void report(const touch_host_point_t* points, uint8_t count)
+{
+    TOUCH_host_report(points, count);
+}
+
+int main(void)
+{
+    touch_host_gt911_t gt911;
+
+    TOUCH_host_reset();
+    TOUCH_init(&i2c, 0);
+    TOUCH_set_touchdown_callback(touchdown);
+    TOUCH_set_touchmove_callback(touchmove);
+    TOUCH_set_touchup_callback(touchup);
+    CHECK(!TOUCH_tasks());
+
+    // one finger down, moved twice, lifted:  a single move to where it
+    // ended up, and the up where it was last seen
+    event_count = 0;
+    report(&(touch_host_point_t){ 0, 100, 200 }, 1);
+    CHECK(TOUCH_tasks());
+    CHECK_EQUAL(event_count, 1);
+    check_event(0, 'd', 0, 100, 200);
+
+    event_count = 0;
+    report(&(touch_host_point_t){ 0, 110, 205 }, 1);
+    report(&(touch_host_point_t){ 0, 120, 210 }, 1);
+    CHECK(TOUCH_tasks());
+    CHECK_EQUAL(event_count, 1);
+    check_event(0, 'm', 0, 120, 210);
+
+    event_count = 0;
+    report(NULL, 0);
+    CHECK(TOUCH_tasks());
+    CHECK_EQUAL(event_count, 1);
+    check_event(0, 'u', 0, 120, 210);
+
+    // two fingers are tracked apart by id
+    event_count = 0;
+    report((touch_host_point_t[]){ { 0, 10, 20 }, { 1, 700, 400 } }, 2);
+    report(&(touch_host_point_t){ 1, 700, 400 }, 1);
+    report(NULL, 0);
+    CHECK(TOUCH_tasks());
+    CHECK_EQUAL(event_count, 4);
+    check_event(0, 'd', 0, 10, 20);
+    check_event(1, 'd', 1, 700, 400);
+    check_event(2, 'u', 0, 10, 20);
+    check_event(3, 'u', 1, 700, 400);
+
+    // every scan was read and its status cleared, so none was lost
+    TOUCH_host_get_gt911(&gt911);
+    CHECK_EQUAL(gt911.reports, 7);
+    CHECK_EQUAL(gt911.reports_dropped, 0);
+
+    // with the bus NAKing the status is never cleared, so the next scan is
+    // dropped by the GT911; the read on the next INT picks up the report
+    // it kept
+    event_count = 0;
+    TOUCH_host_set_nak(true);
+    report(&(touch_host_point_t){ 2, 300, 100 }, 1);
+    report(&(touch_host_point_t){ 2, 310, 100 }, 1);
+    CHECK(!TOUCH_tasks());
+    TOUCH_host_get_gt911(&gt911);
+    CHECK_EQUAL(gt911.reports, 8);
+    CHECK_EQUAL(gt911.reports_dropped, 1);
+
+    TOUCH_host_set_nak(false);
+    TOUCH_host_interrupt();
+    CHECK(TOUCH_tasks());
+    CHECK_EQUAL(event_count, 1);
+    check_event(0, 'd', 2, 300, 100);
+
+    event_count = 0;
+    report(NULL, 0);
+    CHECK(TOUCH_tasks());
+    CHECK_EQUAL(event_count, 1);
+    check_event(0, 'u', 2, 300, 100);
+    TOUCH_host_get_gt911(&gt911);
+    CHECK_EQUAL(gt911.reports_dropped, 1);
+
+    return TEST_RESULT;
+}
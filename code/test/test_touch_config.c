@@ -0,0 +1,102 @@
+// Configure_GT911 (touch.c, run by TOUCH_init) against the register
+// stand-in:  the first init writes the panel resolution, touch number,
+// INT edge and report rate into the module's config and has it taken; an
+// init on a module already set up writes nothing; with the bus NAKing
+// nothing is written at all.
+#include <string.h>
+#include "test.h"
+#include "touch.h"
+
+#define GT911_I2C_SLAVE_ADDRESS     (0x5D)
+#define GT911_REG_CONFIG_START      (0x8047)
+#define GT911_REG_CONFIG_FRESH      (0x8100)
+#define GT911_CONFIG_BYTES          (GT911_REG_CONFIG_FRESH - GT911_REG_CONFIG_START)   // checksum included
+
+static i2c_inst_t i2c = { 0 };
+
+static void read_config(uint8_t* config)
+{
+    const uint8_t address[2] = { GT911_REG_CONFIG_START >> 8, GT911_REG_CONFIG_START & 0xFF };
+    CHECK(TOUCH_host_i2c_transfer(GT911_I2C_SLAVE_ADDRESS, address, sizeof(address), config, GT911_CONFIG_BYTES + 1));
+}
+
+int main(void)
+{
+    touch_host_gt911_t gt911;
+    uint8_t before[GT911_CONFIG_BYTES + 1];
+    uint8_t after[GT911_CONFIG_BYTES + 1];
+    uint16_t width, height;
+
+    // first boot on a module configured for another panel
+    TOUCH_host_reset();
+    read_config(before);
+    TOUCH_init(&i2c, 0);
+
+    TOUCH_host_get_gt911(&gt911);
+    CHECK_EQUAL(gt911.config_writes, 1);
+    CHECK_EQUAL(gt911.configs_taken, 1);
+    CHECK_EQUAL(gt911.configs_rejected, 0);
+    CHECK_EQUAL(gt911.width, 800);
+    CHECK_EQUAL(gt911.height, 480);
+    CHECK_EQUAL(gt911.touch_number, 5);
+    CHECK_EQUAL(gt911.module_switch1 & 0x03, 0x01);     // INT on the falling edge
+    CHECK_EQUAL(gt911.refresh_rate & 0x0F, 0);          // 5ms
+    TOUCH_get_resolution(&width, &height);
+    CHECK_EQUAL(width, 800);
+    CHECK_EQUAL(height, 480);
+
+    // read-modify-write:  the bytes the driver does not set are the
+    // module's own, the checksum is good and config_fresh is back to 0
+    static const uint16_t changed[] =
+    {
+        0x8048, 0x8049, 0x804A, 0x804B,     // X and Y output max
+        0x804C,                             // touch number
+        0x804D,                             // module switch 1
+        0x8053, 0x8054,                     // touch and leave levels
+        0x8056,                             // refresh rate
+        0x80FF,                             // checksum
+    };
+    read_config(after);
+    for (uint16_t i = 0; i < GT911_CONFIG_BYTES; i++)
+    {
+        bool expected_change = false;
+        for (size_t c = 0; c < count_of(changed); c++)
+            expected_change |= (GT911_REG_CONFIG_START + i) == changed[c];
+        if (!expected_change)
+            CHECK_EQUAL(after[i], before[i]);
+    }
+    CHECK_EQUAL(after[GT911_CONFIG_BYTES], 0);
+    uint8_t sum = 0;
+    for (uint16_t i = 0; i < GT911_CONFIG_BYTES; i++)
+        sum += after[i];
+    CHECK_EQUAL(sum, 0);
+    CHECK_EQUAL(gt911.checksum, after[GT911_CONFIG_BYTES - 1]);
+
+    // every later boot finds the config already set and only reads it
+    TOUCH_init(&i2c, 0);
+    TOUCH_host_get_gt911(&gt911);
+    CHECK_EQUAL(gt911.config_writes, 1);
+    CHECK_EQUAL(gt911.configs_taken, 1);
+
+    // no GT911 answering:  init carries on without writing, at the panel
+    // resolution, and the module is configured on the next boot it answers
+    TOUCH_host_reset();
+    TOUCH_host_set_nak(true);
+    TOUCH_init(&i2c, 0);
+    TOUCH_host_set_nak(false);
+    TOUCH_host_get_gt911(&gt911);
+    CHECK_EQUAL(gt911.config_writes, 0);
+    CHECK_EQUAL(gt911.configs_taken, 0);
+    CHECK_EQUAL(gt911.width, 480);
+    TOUCH_get_resolution(&width, &height);
+    CHECK_EQUAL(width, 800);
+    CHECK_EQUAL(height, 480);
+
+    TOUCH_init(&i2c, 0);
+    TOUCH_host_get_gt911(&gt911);
+    CHECK_EQUAL(gt911.config_writes, 1);
+    CHECK_EQUAL(gt911.configs_taken, 1);
+    CHECK_EQUAL(gt911.width, 800);
+
+    return TEST_RESULT;
+}
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+# Generates artwork_skins.c -- the flash resident skins drawn in the panel
+# area beside the game window.
+#
+# Images are palette indexed and stored as one run length encoded row per
+# output line:  (length, palette index) byte pairs, each row padded to a
+# whole word so rows can be fetched by 32 bit DMA.  Palette index 0 is not
+# stored; it is replaced at runtime by the panel background color.
+#
+# usage: python3 artwork_gen.py [name=image.ppm ...] > ../non-touch/artwork_skins.c
+#
+# Extra skins can be supplied as binary PPM (P6) images of ARTWORK_WIDTH x
+# ARTWORK_HEIGHT pixels, in output orientation (one image row per line).
+
+import sys
+
+ARTWORK_WIDTH = 123     # 800/3 - 144, rounded up to a multiple of 3 (see single_scanline)
+ARTWORK_HEIGHT = 160    # 480/3 output lines
+MAX_PALETTE = 16        # ARTWORK_MAX_COLORS
+MAX_ROW_WORDS = 32      # ARTWORK_MAX_ROW_WORDS
+
+
+class Image:
+    def __init__(self, palette):
+        self.palette = [None] + list(palette)     # index 0 = panel background
+        self.pixels = [[0] * ARTWORK_WIDTH for _ in range(ARTWORK_HEIGHT)]
+
+    def rect(self, x, y, w, h, index):
+        for row in range(max(0, y), min(ARTWORK_HEIGHT, y + h)):
+            for col in range(max(0, x), min(ARTWORK_WIDTH, x + w)):
+                self.pixels[row][col] = index
+
+    def circle(self, cx, cy, r, index):
+        for row in range(cy - r, cy + r + 1):
+            for col in range(cx - r, cx + r + 1):
+                if (row - cy) ** 2 + (col - cx) ** 2 <= r * r:
+                    self.rect(col, row, 1, 1, index)
+
+
+def skin_plain():
+    return Image([])
+
+
+def skin_dmg():
+    # DMG bezel:  grey body, maroon and navy pin stripes, red power LED
+    img = Image([0x8C8A94, 0x5A5A66, 0x7B1838, 0x29296B, 0xF70000])
+    img.rect(0, 0, ARTWORK_WIDTH, ARTWORK_HEIGHT, 1)
+    img.rect(6, 8, ARTWORK_WIDTH - 12, ARTWORK_HEIGHT - 16, 2)
+    img.rect(12, 12, 2, ARTWORK_HEIGHT - 24, 3)
+    img.rect(18, 12, 2, ARTWORK_HEIGHT - 24, 4)
+    img.circle(40, 24, 4, 5)
+    return img
+
+
+def skin_gradient():
+    # sunset:  bands from orange to black along the panel, each a distinct RGB222 color
+    bands = [0xFFAA55, 0xFF5555, 0xAA5555, 0xAA0055, 0x550055, 0x000055, 0x000000, 0x000000]
+    img = Image(bands)
+    band_height = ARTWORK_HEIGHT // len(bands)
+    for i in range(len(bands)):
+        img.rect(0, i * band_height, ARTWORK_WIDTH, band_height, i + 1)
+    return img
+
+
+def load_ppm(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    fields = []
+    pos = 0
+    while len(fields) < 4:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b"#":
+            pos = data.index(b"\n", pos)
+            continue
+        end = pos
+        while not data[end:end + 1].isspace():
+            end += 1
+        fields.append(data[pos:end])
+        pos = end
+    pos += 1
+    if fields[0] != b"P6" or int(fields[1]) != ARTWORK_WIDTH or int(fields[2]) != ARTWORK_HEIGHT:
+        sys.exit("%s: expected a %dx%d P6 image" % (path, ARTWORK_WIDTH, ARTWORK_HEIGHT))
+
+    palette = []
+    img = Image([])
+    for row in range(ARTWORK_HEIGHT):
+        for col in range(ARTWORK_WIDTH):
+            r, g, b = data[pos:pos + 3]
+            pos += 3
+            color = (r << 16) | (g << 8) | b
+            if color not in palette:
+                palette.append(color)
+                if len(palette) >= MAX_PALETTE:
+                    sys.exit("%s: more than %d colors" % (path, MAX_PALETTE - 1))
+            img.pixels[row][col] = palette.index(color) + 1
+    img.palette = [None] + palette
+    return img
+
+
+def encode_row(row):
+    out = []
+    col = 0
+    while col < len(row):
+        index = row[col]
+        length = 1
+        while col + length < len(row) and row[col + length] == index and length < 255:
+            length += 1
+        out += [length, index]
+        col += length
+    while len(out) % 4:
+        out.append(0)
+    return [out[i] | (out[i + 1] << 8) | (out[i + 2] << 16) | (out[i + 3] << 24) for i in range(0, len(out), 4)]
+
+
+def emit(skins):
+    print("// Generated by tools/artwork_gen.py -- do not edit by hand")
+    print()
+    print('#include "artwork.h"')
+    for name, img in skins:
+        ident = name.lower()
+        words = []
+        offsets = []
+        for row in img.pixels:
+            offsets.append(len(words))
+            encoded = encode_row(row)
+            if len(encoded) > MAX_ROW_WORDS:
+                sys.exit("%s: row %d needs %d words, more than %d" % (name, len(offsets) - 1, len(encoded), MAX_ROW_WORDS))
+            words += encoded
+        offsets.append(len(words))
+
+        print()
+        print("static const uint32_t %s_palette[] = { 0x000000%s };" % (ident, "".join(", 0x%06X" % c for c in img.palette[1:])))
+        print()
+        print("static const uint16_t %s_rows[ARTWORK_HEIGHT + 1] = " % ident)
+        print("{")
+        for i in range(0, len(offsets), 12):
+            print("    " + ", ".join("%d" % o for o in offsets[i:i + 12]) + ",")
+        print("};")
+        print()
+        print("static const uint32_t %s_data[] = " % ident)
+        print("{")
+        for i in range(0, len(words), 6):
+            print("    " + ", ".join("0x%08X" % w for w in words[i:i + 6]) + ",")
+        print("};")
+
+    print()
+    print("const artwork_t artwork_skins[] = ")
+    print("{")
+    for name, img in skins:
+        ident = name.lower()
+        print("    { .name = \"%s\", .palette_count = %d, .palette = %s_palette, .rows = %s_rows, .data = %s_data }," %
+              (name.upper(), len(img.palette), ident, ident, ident))
+    print("};")
+    print()
+    print("const uint8_t artwork_skin_count = sizeof(artwork_skins) / sizeof(artwork_skins[0]);")
+
+
+def main():
+    skins = [("PLAIN", skin_plain()), ("DMG", skin_dmg()), ("GRADIENT", skin_gradient())]
+    for arg in sys.argv[1:]:
+        name, path = arg.split("=", 1)
+        skins.append((name, load_ppm(path)))
+    emit(skins)
+
+
+if __name__ == "__main__":
+    main()
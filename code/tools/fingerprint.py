@@ -0,0 +1,204 @@
+#!/usr/bin/env python3
+# Computes the title screen fingerprint the firmware reports (fingerprint.c)
+# from a 160x144 screenshot, and adds it to known_titles.h.
+#
+# usage: python3 fingerprint.py [--palette C0,C1,C2,C3] [--raw shades.bin] screenshot.ppm|--boot-logo [SCHEME_NAME]
+#        python3 fingerprint.py --hash 0x12345678 SCHEME_NAME
+#
+# Screenshots are binary PPM (P6) at native resolution, e.g. from an
+# emulator.  The firmware hashes the shade the DMG sends (0 lightest, 3
+# darkest), so each color is mapped to its shade in the palette the
+# screenshot was taken with -- given as four RRGGBB colors, shade 0 first,
+# or else found among the usual emulator palettes and the schemes in
+# color_scheme_table.h.  Ranking only the colors present would get a two
+# shade screen wrong.
+#
+# --boot-logo hashes the screen the boot ROM holds the logo on, which every
+# game shows; add it as FINGERPRINT_SKIP so it is never taken for a title.
+# --hash takes a fingerprint the unit itself reported, from the telemetry
+# stream (tools/telemetry_decode.py), for a game with no screenshot to
+# hand.  --raw writes the screen that was hashed, a shade byte per pixel
+# in rows, for checking the firmware against (code/test).
+#
+# With a scheme name the entry is inserted into both copies of
+# known_titles.h, keeping them sorted.
+
+import os
+import re
+import sys
+
+WIDTH = 160
+HEIGHT = 144
+TILES_X = 20
+TILES_Y = 18
+FNV_OFFSET = 2166136261
+FNV_PRIME = 16777619
+SETTINGS_DEFAULT_GAME = 0
+COLOR_TOLERANCE = 16            # per channel, for emulator color rounding
+
+# shade 0 .. 3
+EMULATOR_PALETTES = {
+    "grey": [0xFFFFFF, 0xAAAAAA, 0x555555, 0x000000],
+    "bgb": [0xE0F8D0, 0x88C070, 0x346856, 0x081820],
+}
+
+# cartridge header logo, as the boot ROM checks it, and its (R) tile
+BOOT_LOGO = bytes.fromhex(
+    "CEED6666CC0D000B03730083000C000D0008111F8889000E"
+    "DCCC6EE6DDDDD999BBBB67636E0EECCCDDDC999FBBB9333E")
+BOOT_LOGO_R = bytes.fromhex("3C42B9A5B9A5423C")
+
+
+def load_ppm(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    fields = []
+    pos = 0
+    while len(fields) < 4:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b"#":
+            pos = data.index(b"\n", pos)
+            continue
+        end = pos
+        while not data[end:end + 1].isspace():
+            end += 1
+        fields.append(data[pos:end])
+        pos = end
+    pos += 1
+    if fields[0] != b"P6" or int(fields[1]) != WIDTH or int(fields[2]) != HEIGHT:
+        sys.exit("%s: expected a %dx%d P6 image" % (path, WIDTH, HEIGHT))
+
+    pixels = []
+    for y in range(HEIGHT):
+        pixels.append([tuple(data[pos + (y * WIDTH + x) * 3:pos + (y * WIDTH + x) * 3 + 3]) for x in range(WIDTH)])
+    return pixels
+
+
+def rgb(value):
+    return ((value >> 16) & 0xFF, (value >> 8) & 0xFF, value & 0xFF)
+
+
+def scheme_palettes():
+    palettes = {}
+    table = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "non-touch", "color_scheme_table.h")
+    with open(table) as f:
+        for name, *colors in re.findall(r"X\((\w+),\s*(0x\w+),\s*(0x\w+),\s*(0x\w+),\s*(0x\w+)\)", f.read()):
+            palettes[name] = [int(c, 16) for c in colors]
+    return palettes
+
+
+def match(colors, palette):
+    # shade for each color, or None if a color is not in the palette
+    shades = {}
+    for c in colors:
+        near = [shade for shade, p in enumerate(palette)
+                if all(abs(a - b) <= COLOR_TOLERANCE for a, b in zip(c, rgb(p)))]
+        if len(near) != 1:
+            return None
+        shades[c] = near[0]
+    return shades
+
+
+def shades(pixels, palette=None):
+    colors = {c for row in pixels for c in row}
+    if palette is not None:
+        mapping = match(colors, palette)
+        if mapping is None:
+            sys.exit("screenshot colors are not all in the palette given")
+    else:
+        # emulator palettes first, as the schemes include inverted ones
+        for palettes in (EMULATOR_PALETTES, scheme_palettes()):
+            found = {name: m for name, m in ((name, match(colors, p)) for name, p in palettes.items()) if m}
+            if found:
+                break
+        if not found or len({tuple(sorted(m.items())) for m in found.values()}) != 1:
+            sys.exit("cannot tell which palette the screenshot uses%s; give it with --palette"
+                     % (" (%s)" % ", ".join(sorted(found)) if found else ""))
+        mapping = next(iter(found.values()))
+    return [[mapping[c] for c in row] for row in pixels]
+
+
+def boot_logo_screen():
+    # Each logo bit is drawn 2x2, the top half of the logo in tile row 8 and
+    # the bottom half in row 9 from tile 4, (R) at tile 16 of row 8, in
+    # shade 3 on shade 0 once the scroll has stopped
+    screen = [[0] * WIDTH for _ in range(HEIGHT)]
+    for i, byte in enumerate(BOOT_LOGO):
+        half, column, pair = i // 24, (i % 24) // 2, i % 2
+        for nibble in range(2):
+            bits = (byte >> (4 - 4 * nibble)) & 0xF
+            row = half * 4 + pair * 2 + nibble
+            for bit in range(4):
+                if bits & (8 >> bit):
+                    for dy in range(2):
+                        for dx in range(2):
+                            screen[64 + row * 2 + dy][32 + (column * 4 + bit) * 2 + dx] = 3
+    for row, byte in enumerate(BOOT_LOGO_R):
+        for bit in range(8):
+            if byte & (0x80 >> bit):
+                screen[64 + row][128 + bit] = 3
+    return screen
+
+
+def fingerprint(screen):
+    h = FNV_OFFSET
+    for tile_y in range(TILES_Y):
+        for tile_x in range(TILES_X):
+            h = ((h ^ screen[tile_y * 8 + 4][tile_x * 8 + 4]) * FNV_PRIME) & 0xFFFFFFFF
+    return h if h != SETTINGS_DEFAULT_GAME else h + 1
+
+
+def insert(path, value, scheme):
+    with open(path) as f:
+        text = f.read()
+    pattern = re.compile(r"    X\((0x[0-9A-Fa-f]+), (\w+)\) \\\n")
+    entries = {int(v, 16): s for v, s in pattern.findall(text)}
+    entries[value] = scheme
+    body = "".join("    X(0x%08X, %s) \\\n" % (v, entries[v]) for v in sorted(entries))
+    head = text.index("#define KNOWN_TITLE_TABLE(X) \\\n") + len("#define KNOWN_TITLE_TABLE(X) \\\n")
+    tail = text.index("\n#endif")
+    with open(path, "w") as f:
+        f.write(text[:head] + body + text[tail:])
+
+
+def main(argv):
+    palette = None
+    raw = None
+    value = None
+    args = []
+    while argv:
+        arg = argv.pop(0)
+        if arg == "--palette" and argv:
+            palette = [int(c, 16) for c in argv.pop(0).split(",")]
+            if len(palette) != 4:
+                sys.exit("--palette takes four colors, shade 0 first")
+        elif arg == "--raw" and argv:
+            raw = argv.pop(0)
+        elif arg == "--hash" and argv:
+            value = int(argv.pop(0), 16)
+        else:
+            args.append(arg)
+    if value is not None:
+        if len(args) != 1:
+            sys.exit("--hash needs the scheme name to add it with")
+        args.insert(0, None)
+    elif not 1 <= len(args) <= 2:
+        sys.exit("usage: fingerprint.py [--palette C0,C1,C2,C3] [--raw shades.bin] screenshot.ppm|--boot-logo [SCHEME_NAME]\n"
+                 "       fingerprint.py --hash 0x12345678 SCHEME_NAME")
+    else:
+        screen = boot_logo_screen() if args[0] == "--boot-logo" else shades(load_ppm(args[0]), palette)
+        value = fingerprint(screen)
+        if raw is not None:
+            with open(raw, "wb") as f:
+                f.write(bytes(shade for row in screen for shade in row))
+    print("0x%08X" % value)
+
+    if len(args) > 1:
+        here = os.path.dirname(os.path.abspath(__file__))
+        for variant in ("non-touch", "touch"):
+            insert(os.path.join(here, "..", variant, "known_titles.h"), value, args[1])
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
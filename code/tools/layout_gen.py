@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+# Builds on-screen controls layout images for the touch build (see layout.h).
+#
+# usage: python3 layout_gen.py [layouts.json] > ../touch/layout_presets.c
+#        python3 layout_gen.py --bin layouts.bin [--flash-size bytes] [layouts.json]
+#
+# With no file the presets below are built.  A JSON file holds a list of
+# layouts in the same form as the presets, e.g.
+#
+#   [{"name": "MINE", "calibration": [256, 0, 0, 256, 0, 0],
+#     "areas": [{"cell": 4, "group": 1, "cells": 2, "groups": 2,
+#                "buttons": ["A"], "shape": "round", "color": "ab"}]}]
+#
+# calibration is xx, xy, yx, yy (256 is 1.0) and the x, y offsets in 3x
+# scale pixels.  --bin writes an image for the layout sector instead of the
+# C source; load it with picotool at the address printed, and it replaces
+# the presets on the next boot.
+
+import json
+import struct
+import sys
+
+MAGIC = 0x594C4247              # LAYOUT_MAGIC
+VERSION = 1
+MAX_BYTES = 4096                # LAYOUT_MAX_BYTES
+MAX_LAYOUTS = 8
+NAME_LENGTH = 12
+SECTOR_SIZE = 4096
+XIP_BASE = 0x10000000
+CELLS = 12                      # CONTROLS_ROWS
+GROUPS = 16                     # CONTROLS_LINE_GROUPS
+UPRIGHT_CELLS = 10              # the panel with the game window at 0 or 180
+UPRIGHT_GROUPS = 15
+
+BUTTONS = ["A", "B", "SELECT", "START", "UP", "DOWN", "LEFT", "RIGHT", "HOME"]
+SHAPES = ["rect", "round"]
+COLORS = ["none", "other", "ab"]
+IDENTITY = [256, 0, 0, 256, 0, 0]
+
+
+def area(cell, group, cells, groups, buttons, shape="rect", color="other"):
+    return {"cell": cell, "group": group, "cells": cells, "groups": groups,
+            "buttons": buttons, "shape": shape, "color": color}
+
+
+def dpad(cell, group, size):
+    # arms size cells square around a dead middle, corners pressing both
+    # directions.  UP is nearest the game window and LEFT furthest down.
+    near, mid, far = cell, cell + size, cell + 2 * size
+    top, middle, bottom = group, group + size, group + 2 * size
+    return [
+        area(near, middle, size, size, ["UP"]),
+        area(far, middle, size, size, ["DOWN"]),
+        area(mid, bottom, size, size, ["LEFT"]),
+        area(mid, top, size, size, ["RIGHT"]),
+        area(near, top, size, size, ["UP", "RIGHT"], color="none"),
+        area(near, bottom, size, size, ["UP", "LEFT"], color="none"),
+        area(far, top, size, size, ["DOWN", "RIGHT"], color="none"),
+        area(far, bottom, size, size, ["DOWN", "LEFT"], color="none"),
+    ]
+
+
+def layout_standard():
+    return {"name": "STANDARD", "calibration": IDENTITY, "areas": [
+        area(0, 1, 1, 2, ["START"]),
+        area(0, 7, 1, 2, ["HOME"]),
+        area(0, 13, 1, 2, ["SELECT"]),
+        area(4, 1, 2, 2, ["A"], color="ab"),
+        area(6, 4, 2, 2, ["B"], color="ab"),
+    ] + dpad(4, 9, 2)}
+
+
+def layout_left_handed():
+    # the standard layout turned end for end down the panel
+    layout = layout_standard()
+    for a in layout["areas"]:
+        a["group"] = GROUPS - a["group"] - a["groups"]
+        a["buttons"] = [{"LEFT": "RIGHT", "RIGHT": "LEFT"}.get(b, b) for b in a["buttons"]]
+    layout["name"] = "LEFT HANDED"
+    return layout
+
+
+def layout_compact():
+    # against the game window, leaving the outer panel to the artwork
+    return {"name": "COMPACT", "calibration": IDENTITY, "areas": [
+        area(0, 1, 1, 2, ["START"]),
+        area(0, 7, 1, 2, ["HOME"]),
+        area(0, 13, 1, 2, ["SELECT"]),
+        area(1, 1, 2, 2, ["A"], color="ab"),
+        area(3, 3, 2, 2, ["B"], color="ab"),
+    ] + dpad(1, 9, 2)}
+
+
+def layout_large():
+    return {"name": "LARGE", "calibration": IDENTITY, "areas": [
+        area(0, 0, 1, 3, ["START"]),
+        area(0, 6, 1, 3, ["HOME"]),
+        area(0, 13, 1, 3, ["SELECT"]),
+        area(1, 0, 4, 4, ["A"], "round", "ab"),
+        area(5, 3, 4, 4, ["B"], "round", "ab"),
+    ] + dpad(3, 7, 3)}
+
+
+def encode(layouts):
+    if not 0 < len(layouts) <= MAX_LAYOUTS:
+        sys.exit("need 1 to %d layouts" % MAX_LAYOUTS)
+    body = b""
+    for layout in layouts:
+        name = layout["name"].encode("ascii")
+        if len(name) >= NAME_LENGTH:
+            sys.exit("%s: name longer than %d characters" % (layout["name"], NAME_LENGTH - 1))
+        areas = layout["areas"]
+        body += struct.pack("<%ds6hB3x" % NAME_LENGTH, name, *layout.get("calibration", IDENTITY), len(areas))
+        if any(a["cell"] + a["cells"] > UPRIGHT_CELLS or a["group"] + a["groups"] > UPRIGHT_GROUPS for a in areas):
+            sys.stderr.write("%s: off the upright panel, so only offered at 90 and 270\n" % layout["name"])
+        for a in areas:
+            if a["cell"] + a["cells"] > CELLS or a["group"] + a["groups"] > GROUPS:
+                sys.exit("%s: area %s is off the panel" % (layout["name"], a))
+            buttons = 0
+            for button in a["buttons"]:
+                buttons |= 1 << BUTTONS.index(button)
+            body += struct.pack("<4BH2B", a["cell"], a["group"], a["cells"], a["groups"], buttons,
+                                SHAPES.index(a.get("shape", "rect")), COLORS.index(a.get("color", "other")))
+    length = 16 + len(body)
+    if length > MAX_BYTES:
+        sys.exit("%d bytes, more than the %d byte sector" % (length, MAX_BYTES))
+    return struct.pack("<IHHII", MAGIC, VERSION, len(layouts), length, fnv1a(body)) + body
+
+
+def fnv1a(data):
+    value = 2166136261
+    for byte in data:
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def emit(image, layouts):
+    words = struct.unpack("<%dI" % (len(image) // 4), image)
+    print("// Generated by tools/layout_gen.py -- do not edit by hand")
+    print("// %s" % ", ".join(layout["name"] for layout in layouts))
+    print()
+    print('#include "layout.h"')
+    print()
+    print("const uint32_t layout_presets[] = ")
+    print("{")
+    for i in range(0, len(words), 6):
+        print("    " + ", ".join("0x%08X" % w for w in words[i:i + 6]) + ",")
+    print("};")
+    print()
+    print("const uint32_t layout_presets_length = sizeof(layout_presets);")
+
+
+def main(argv):
+    bin_path = None
+    flash_size = 2 * 1024 * 1024
+    paths = []
+    while argv:
+        arg = argv.pop(0)
+        if arg == "--bin" and argv:
+            bin_path = argv.pop(0)
+        elif arg == "--flash-size" and argv:
+            flash_size = int(argv.pop(0), 0)
+        else:
+            paths.append(arg)
+    if len(paths) > 1:
+        print("usage: layout_gen.py [--bin layouts.bin [--flash-size bytes]] [layouts.json]")
+        return 2
+
+    if paths:
+        with open(paths[0]) as f:
+            layouts = json.load(f)
+    else:
+        layouts = [layout_standard(), layout_left_handed(), layout_compact(), layout_large()]
+    image = encode(layouts)
+
+    if bin_path:
+        with open(bin_path, "wb") as f:
+            f.write(image)
+        address = XIP_BASE + flash_size - 2 * SECTOR_SIZE     # LAYOUT_FLASH_OFFSET
+        print("%d bytes; load with  picotool load -o 0x%08X %s" % (len(image), address, bin_path), file=sys.stderr)
+    else:
+        emit(image, layouts)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+# Reports where the time critical code and data of a linked firmware image
+# ended up:  flash (run over XIP), the striped main SRAM, or the SRAM4/SRAM5
+# scratch banks.  Render runs on core1 (stack and render data in SRAM4),
+# capture on core0 (stack and capture data in SRAM5).
+#
+# usage: python3 memory_report.py [--nm arm-none-eabi-nm] [--check] gameboy_xl.elf
+#
+# With --check the exit status is 1 when a hot function is in flash.
+
+import fnmatch
+import subprocess
+import sys
+
+REGIONS = [
+    (0x10000000, 0x11000000, "flash"),
+    (0x20000000, 0x20040000, "sram0-3"),
+    (0x20040000, 0x20041000, "sram4 core1"),
+    (0x20041000, 0x20042000, "sram5 core0"),
+]
+
+# Called for every scanline, pixel clock or joypad edge.  Patterns that match
+# nothing (touch only functions in the non-touch image) are skipped.
+HOT_FUNCTIONS = [
+    "render_scanline",
+    "single_scanline",
+    "single_solid_line",
+    "gpio_callback",
+    "gpio_callback_VIDEO",
+    "capture_ORIENTATION_*",
+    "command_check",
+    "rgb888_to_rgb222",
+    "get_scheme_lut",
+    "get_region_lut",
+    "get_palette_segments",
+    "get_dot_matrix_templates",
+    "get_ambient_enabled",
+    "ambient_end_frame",
+    "OSD_is_enabled",
+    "ARTWORK_run",
+    "ARTWORK_render_line",
+    "get_row",
+    "FINGERPRINT_capture_frame",
+    "RENDER_STATS_record",
+    "LATENCY_input",
+    "LATENCY_game_read",
+    "LATENCY_frame_captured",
+    "LATENCY_rendered",
+    "TOUCH_capture_gap",
+    "IntHandler_GT911",
+    "ReportReady_GT911",
+    "StartReadPoints_GT911",
+    "StartTransfer_GT911",
+    "TransferDone_GT911",
+    "QueueReport_GT911",
+    "I2cIrqHandler_GT911",
+]
+
+HOT_DATA = [
+    "framebuffer",
+    "scheme_lut_buffers",
+    "dot_matrix_template_buffers",
+    "palette_layouts",
+    "ambient_tokens",
+    "edge_sum",
+    "levels",
+    "row_cache",
+    "palette_tokens",
+    "controls_lines",
+    "line_stats",
+]
+
+
+def region_of(address):
+    for start, end, name in REGIONS:
+        if start <= address < end:
+            return name
+    return "?"
+
+
+def read_symbols(nm, elf):
+    output = subprocess.run([nm, "-S", "--defined-only", elf], check=True,
+                            capture_output=True, text=True).stdout
+    symbols = []
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) != 4:
+            continue
+        address, size, kind, name = fields
+        symbols.append((name, kind, int(address, 16), int(size, 16)))
+    return symbols
+
+
+def report(title, patterns, symbols, functions):
+    print(title)
+    in_flash = []
+    for pattern in patterns:
+        for name, kind, address, size in symbols:
+            if not fnmatch.fnmatchcase(name, pattern):
+                continue
+            if (kind.lower() == "t") != functions:
+                continue
+            region = region_of(address)
+            print("  %-32s %-12s 0x%08X %6d" % (name, region, address, size))
+            if region == "flash":
+                in_flash.append(name)
+    return in_flash
+
+
+def main(argv):
+    nm = "arm-none-eabi-nm"
+    check = False
+    args = []
+    i = 0
+    while i < len(argv):
+        if argv[i] == "--nm":
+            nm = argv[i + 1]
+            i += 2
+            continue
+        if argv[i] == "--check":
+            check = True
+        else:
+            args.append(argv[i])
+        i += 1
+    if len(args) != 1:
+        print("usage: memory_report.py [--nm arm-none-eabi-nm] [--check] firmware.elf")
+        return 2
+
+    symbols = read_symbols(nm, args[0])
+    in_flash = report("hot functions", HOT_FUNCTIONS, symbols, True)
+    report("hot data", HOT_DATA, symbols, False)
+
+    if in_flash:
+        print("in flash: " + ", ".join(in_flash))
+        return 1 if check else 0
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
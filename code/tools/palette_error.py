@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+# Reports how far each color scheme lands from its 24 bit palette on the
+# RGB222 panel, with plain truncation and with FRC dithering (time average).
+#
+# usage: python3 palette_error.py [path/to/color_scheme_table.h]
+
+import math
+import os
+import re
+import sys
+
+FRC_PHASES = 4
+
+
+def load_schemes(path):
+    schemes = []
+    pattern = re.compile(r"X\((SCHEME_\w+),([^)]*)\)")
+    with open(path) as f:
+        for name, body in pattern.findall(f.read()):
+            colors = [int(c.strip(), 16) for c in body.split(",")]
+            schemes.append((name, colors))
+    return schemes
+
+
+def channels(color):
+    return ((color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF)
+
+
+def truncate(value):
+    return value >> 6
+
+
+def frc(value, phase):
+    # must match frc_channel() in colors.c
+    level = value // 85
+    remainder = value - level * 85
+    high_phases = (remainder * FRC_PHASES + 42) // 85
+    if level < 3 and phase < high_phases:
+        level += 1
+    return level
+
+
+def error(color, shown):
+    return math.sqrt(sum((a - b) ** 2 for a, b in zip(channels(color), shown)))
+
+
+def truncated_color(color):
+    return tuple(truncate(c) * 85 for c in channels(color))
+
+
+def dithered_color(color):
+    return tuple(sum(frc(c, p) * 85 for p in range(FRC_PHASES)) / FRC_PHASES for c in channels(color))
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    path = sys.argv[1] if len(sys.argv) > 1 else os.path.join(here, "..", "non-touch", "color_scheme_table.h")
+
+    print("%-24s %10s %10s %10s %10s" % ("scheme", "trunc err", "frc err", "trunc dup", "frc dup"))
+    totals = [0.0, 0.0]
+    for name, colors in load_schemes(path):
+        trunc = [truncated_color(c) for c in colors]
+        dith = [dithered_color(c) for c in colors]
+        trunc_err = sum(error(c, s) for c, s in zip(colors, trunc)) / len(colors)
+        frc_err = sum(error(c, s) for c, s in zip(colors, dith)) / len(colors)
+        totals[0] += trunc_err
+        totals[1] += frc_err
+        print("%-24s %10.1f %10.1f %10d %10d" % (name, trunc_err, frc_err,
+                                                  len(colors) - len(set(trunc)), len(colors) - len(set(dith))))
+
+    count = len(load_schemes(path))
+    print("%-24s %10.1f %10.1f" % ("MEAN", totals[0] / count, totals[1] / count))
+
+
+if __name__ == "__main__":
+    main()
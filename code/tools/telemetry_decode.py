@@ -0,0 +1,284 @@
+#!/usr/bin/env python3
+# Decodes the firmware telemetry stream (see telemetry.h) from a file, a
+# pipe or the USB serial port, printing each record or, with --summary,
+# totals once the stream ends or is interrupted.
+#
+# usage: python3 telemetry_decode.py [--summary] [--touch] stream.bin|/dev/ttyACM0|-
+#
+# --touch names the buttons of the touch build, which adds HOME.  Put a
+# serial port in raw mode first:
+#   stty -F /dev/ttyACM0 raw -echo
+
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+VERSION = 1
+FRAME_HEADER = "<BBBB"          # version, type, sequence, length
+
+CAPTURE, RENDER, BUTTONS, TOUCH, LATENCY, FINGERPRINT = 1, 2, 3, 4, 5, 6
+RENDER_BINS = 48
+FORMATS = {
+    CAPTURE: "<IIIIIIIIH",
+    RENDER: "<IBBH%dH" % RENDER_BINS,
+    BUTTONS: "<IH",
+    TOUCH: "<IHHB",
+    LATENCY: "<IH4I",
+    FINGERPRINT: "<IIb",
+}
+FINGERPRINT_UNKNOWN = -1
+FINGERPRINT_SKIP = -2
+LINE_TYPES = ["SOLID", "GAME", "GAME_OSD", "GAME_CONTROLS"]
+LATENCY_STAGES = ["touch poll", "game", "capture", "render", "total"]
+BUTTONS_NON_TOUCH = ["A", "B", "SELECT", "START", "UP", "DOWN", "LEFT", "RIGHT"]
+BUTTONS_TOUCH = BUTTONS_NON_TOUCH + ["HOME"]
+
+
+def crc8(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+class Decoder:
+    # Feed it bytes in any chunks; complete records come back from feed()
+    def __init__(self):
+        self.buffer = bytearray()
+        self.bytes = 0
+        self.bad_crc = 0
+        self.bad_version = 0
+        self.unknown = 0
+        self.skipped = 0
+        self.dropped = 0
+        self.sequence = None
+
+    def feed(self, data):
+        self.bytes += len(data)
+        self.buffer += data
+        records = []
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                # keep a trailing first sync byte
+                keep = 1 if self.buffer[-1:] == SYNC[:1] else 0
+                self.skipped += len(self.buffer) - keep
+                del self.buffer[:len(self.buffer) - keep]
+                return records
+            self.skipped += start
+            del self.buffer[:start]
+            if len(self.buffer) < 2 + 4:
+                return records
+            version, kind, sequence, length = struct.unpack_from(FRAME_HEADER, self.buffer, 2)
+            end = 2 + 4 + length + 1
+            if len(self.buffer) < end:
+                return records
+            body = bytes(self.buffer[2:end - 1])
+            if crc8(body) != self.buffer[end - 1]:
+                # not a frame after all -- look for the next sync past this one
+                self.bad_crc += 1
+                self.skipped += 1
+                del self.buffer[:1]
+                continue
+            del self.buffer[:end]
+            if version != VERSION:
+                self.bad_version += 1
+                continue
+            # the firmware counts records it had to drop
+            if self.sequence is not None:
+                self.dropped += (sequence - self.sequence - 1) & 0xFF
+            self.sequence = sequence
+            fields = self.unpack(kind, body[4:])
+            if fields is not None:
+                records.append((kind, fields))
+
+    def unpack(self, kind, payload):
+        fmt = FORMATS.get(kind)
+        if fmt is None or struct.calcsize(fmt) != len(payload):
+            self.unknown += 1
+            return None
+        return struct.unpack(fmt, payload)
+
+
+def percentile(bins, shift, fraction):
+    total = sum(bins)
+    if total == 0:
+        return 0
+    seen = 0
+    for n, count in enumerate(bins):
+        seen += count
+        if seen >= total * fraction:
+            return (n + 1) << shift        # upper edge of the bin
+    return len(bins) << shift
+
+
+def format_record(kind, fields, button_names):
+    time_s = fields[0] / 1e6
+    if kind == CAPTURE:
+        (_, frames, aborted, short_lines, late_edges, frame_us,
+         line_min, line_max, pixels_min) = fields
+        return ("%12.6f capture frames=%d aborted=%d short_lines=%d late_edges=%d frame_us=%d "
+                "line_cycles=%d..%d pixels_min=%d" % (time_s, frames, aborted, short_lines, late_edges,
+                                                      frame_us, line_min, line_max, pixels_min))
+    if kind == RENDER:
+        line_type, shift, missed, bins = fields[1], fields[2], fields[3], fields[4:]
+        return "%12.6f render %-13s lines=%d missed=%d p50=%d p99=%d" % (
+            time_s, LINE_TYPES[line_type] if line_type < len(LINE_TYPES) else line_type,
+            sum(bins), missed, percentile(bins, shift, 0.5), percentile(bins, shift, 0.99))
+    if kind == BUTTONS:
+        pressed = [name for n, name in enumerate(button_names) if fields[1] & (1 << n)]
+        return "%12.6f buttons %s" % (time_s, " ".join(pressed) or "-")
+    if kind == LATENCY:
+        pressed = [name for n, name in enumerate(button_names) if fields[1] & (1 << n)]
+        stages = list(fields[2:]) + [sum(fields[2:])]
+        return "%12.6f latency %s %s" % (time_s, " ".join(pressed) or "-", "  ".join(
+            "%s %.1f ms" % (name, us / 1000) for name, us in zip(LATENCY_STAGES, stages)))
+    if kind == FINGERPRINT:
+        scheme = fields[2]
+        known = ("unknown -- add with fingerprint.py --hash 0x%08X SCHEME_NAME" % fields[1]
+                 if scheme == FINGERPRINT_UNKNOWN else "skipped" if scheme == FINGERPRINT_SKIP else "scheme %d" % scheme)
+        return "%12.6f fingerprint 0x%08X %s" % (time_s, fields[1], known)
+    if kind == TOUCH:
+        return "%12.6f touch %s x=%d y=%d" % (time_s, "down" if fields[3] else "up", fields[1], fields[2])
+    return "%12.6f type %d" % (time_s, kind)
+
+
+class Summary:
+    def __init__(self, button_names):
+        self.button_names = button_names
+        self.counts = {}
+        self.first_us = None
+        self.last_us = None
+        self.capture_first = None
+        self.capture_last = None
+        self.frame_us = []
+        self.render = {}
+        self.presses = [0] * len(button_names)
+        self.previous_pressed = 0
+        self.touches = 0
+        self.latency = [[] for _ in LATENCY_STAGES]
+
+    def add(self, kind, fields):
+        self.counts[kind] = self.counts.get(kind, 0) + 1
+        # time_us wraps every 71 minutes; a summary spans much less
+        time_us = fields[0]
+        if self.first_us is None:
+            self.first_us = time_us
+        self.last_us = time_us
+        if kind == CAPTURE:
+            if self.capture_first is None:
+                self.capture_first = fields
+            self.capture_last = fields
+            if fields[5]:
+                self.frame_us.append(fields[5])
+        elif kind == RENDER:
+            line_type, shift, missed, bins = fields[1], fields[2], fields[3], fields[4:]
+            total = self.render.setdefault(line_type, [shift, 0, [0] * len(bins)])
+            total[1] += missed
+            total[2] = [a + b for a, b in zip(total[2], bins)]
+        elif kind == BUTTONS:
+            for n in range(len(self.button_names)):
+                if fields[1] & ~self.previous_pressed & (1 << n):
+                    self.presses[n] += 1
+            self.previous_pressed = fields[1]
+        elif kind == TOUCH and fields[3]:
+            self.touches += 1
+        elif kind == LATENCY:
+            stages = list(fields[2:]) + [sum(fields[2:])]
+            for samples, us in zip(self.latency, stages):
+                samples.append(us)
+
+    def print(self, decoder):
+        span_us = (self.last_us - self.first_us) & 0xFFFFFFFF if self.first_us is not None else 0
+        print("stream")
+        print("  bytes %d  records %d  span %.1f s" % (decoder.bytes, sum(self.counts.values()), span_us / 1e6))
+        if span_us:
+            print("  %.0f bytes/s  %.1f records/s" % (decoder.bytes * 1e6 / span_us,
+                                                   sum(self.counts.values()) * 1e6 / span_us))
+        print("  dropped %d  bad crc %d  bad version %d  unknown %d  skipped bytes %d" % (
+            decoder.dropped, decoder.bad_crc, decoder.bad_version, decoder.unknown, decoder.skipped))
+
+        if self.capture_last is not None:
+            first, last = self.capture_first, self.capture_last
+            print("capture")
+            print("  frames %d  aborted %d  short lines %d  late edges %d" % (
+                last[1] - first[1], last[2] - first[2], last[3] - first[3], last[4] - first[4]))
+            if self.frame_us:
+                print("  frame us %d..%d" % (min(self.frame_us), max(self.frame_us)))
+
+        if self.render:
+            print("render cycles per scanline")
+            for line_type in sorted(self.render):
+                shift, missed, bins = self.render[line_type]
+                name = LINE_TYPES[line_type] if line_type < len(LINE_TYPES) else str(line_type)
+                print("  %-13s lines %8d  missed %6d  p50 %6d  p99 %6d" % (
+                    name, sum(bins), missed, percentile(bins, shift, 0.5), percentile(bins, shift, 0.99)))
+
+        if self.latency[0]:
+            print("input to photon latency, ms")
+            for name, samples in zip(LATENCY_STAGES, self.latency):
+                ordered = sorted(samples)
+                print("  %-10s samples %4d  mean %5.1f  p50 %5.1f  p99 %5.1f  worst %5.1f" % (
+                    name, len(ordered), sum(ordered) / len(ordered) / 1000,
+                    ordered[len(ordered) // 2] / 1000, ordered[min(len(ordered) - 1, len(ordered) * 99 // 100)] / 1000,
+                    ordered[-1] / 1000))
+            # total in 1ms bins
+            bins = {}
+            for us in self.latency[-1]:
+                bins[us // 1000] = bins.get(us // 1000, 0) + 1
+            most = max(bins.values())
+            for ms in range(min(bins), max(bins) + 1):
+                count = bins.get(ms, 0)
+                print("  %3d ms %4d %s" % (ms, count, "#" * ((count * 40 + most - 1) // most)))
+
+        if self.counts.get(BUTTONS) or self.touches:
+            print("input")
+            presses = ["%s %d" % (name, count) for name, count in zip(self.button_names, self.presses) if count]
+            print("  presses %s" % (", ".join(presses) or "none"))
+            print("  touches %d" % self.touches)
+
+
+def main(argv):
+    summary = False
+    button_names = BUTTONS_NON_TOUCH
+    args = []
+    for arg in argv:
+        if arg == "--summary":
+            summary = True
+        elif arg == "--touch":
+            button_names = BUTTONS_TOUCH
+        else:
+            args.append(arg)
+    if len(args) != 1:
+        print("usage: telemetry_decode.py [--summary] [--touch] stream.bin|/dev/ttyACM0|-")
+        return 2
+
+    decoder = Decoder()
+    totals = Summary(button_names)
+    stream = sys.stdin.buffer if args[0] == "-" else open(args[0], "rb", buffering=0)
+    read = getattr(stream, "read1", stream.read)     # whatever has arrived, not a full block
+    try:
+        while True:
+            data = read(4096)
+            if not data:
+                break
+            for kind, fields in decoder.feed(data):
+                if summary:
+                    totals.add(kind, fields)
+                else:
+                    print(format_record(kind, fields, button_names), flush=True)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if stream is not sys.stdin.buffer:
+            stream.close()
+
+    if summary:
+        totals.print(decoder)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
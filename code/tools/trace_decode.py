@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+# Converts a dump of the firmware event trace (trace_buffer, see trace.h)
+# into Chrome trace JSON, for chrome://tracing or ui.perfetto.dev.  Each
+# core is a thread; event names come from TRACE_EVENT_TABLE in trace.h.
+#
+# usage: python3 trace_decode.py [--header trace.h] trace.bin [trace.json]
+#
+# Take the dump from the debugger while the firmware is halted:
+#   (gdb) dump binary value trace.bin trace_buffer
+
+import json
+import os
+import re
+import struct
+import sys
+
+TRACE_MAGIC = 0x45435254
+TRACE_VERSION = 1
+HEADER_FORMAT = "<IHH"
+RING_HEAD_FORMAT = "<I"
+EVENT_FORMAT = "<IBcH"
+PHASES = {b"B": "B", b"E": "E", b"i": "i", b"C": "C"}
+
+
+def event_names(header):
+    with open(header) as f:
+        text = f.read()
+    start = text.index("#define TRACE_EVENT_TABLE(X)")
+    end = text.index("\n\n", start)
+    return re.findall(r"X\((\w+)\)", text[start:end])
+
+
+def read_rings(data):
+    magic, version, events_per_core = struct.unpack_from(HEADER_FORMAT, data, 0)
+    if magic != TRACE_MAGIC:
+        sys.exit("not a trace dump (magic 0x%08X)" % magic)
+    if version != TRACE_VERSION:
+        sys.exit("trace version %d, expected %d" % (version, TRACE_VERSION))
+
+    event_size = struct.calcsize(EVENT_FORMAT)
+    ring_size = struct.calcsize(RING_HEAD_FORMAT) + events_per_core * event_size
+    offset = struct.calcsize(HEADER_FORMAT)
+    rings = []
+    while offset + ring_size <= len(data):
+        (head,) = struct.unpack_from(RING_HEAD_FORMAT, data, offset)
+        base = offset + struct.calcsize(RING_HEAD_FORMAT)
+        # oldest first -- once the ring has wrapped the oldest is at head
+        count = min(head, events_per_core)
+        events = []
+        for n in range(head - count, head):
+            slot = n % events_per_core
+            events.append(struct.unpack_from(EVENT_FORMAT, data, base + slot * event_size))
+        rings.append(events)
+        offset += ring_size
+    return rings
+
+
+def unwrap_times(events):
+    # the microsecond timer is 32 bits and wraps every 71 minutes
+    high = 0
+    previous = None
+    for time_us, event_id, phase, arg in events:
+        if previous is not None and time_us + high < previous - (1 << 31):
+            high += 1 << 32
+        previous = time_us + high
+        yield previous, event_id, phase, arg
+
+
+def chrome_events(rings, names):
+    out = []
+    start = None
+    for core, events in enumerate(rings):
+        out.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": core, "args": {"name": "core%d" % core}})
+        open_spans = {}
+        for time_us, event_id, phase, arg in unwrap_times(events):
+            name = names[event_id] if event_id < len(names) else "EVENT_%d" % event_id
+            ph = PHASES.get(phase)
+            if ph is None:
+                continue
+            # an end whose begin was overwritten by the ring would confuse the viewer
+            if ph == "B":
+                open_spans[name] = open_spans.get(name, 0) + 1
+            elif ph == "E":
+                if open_spans.get(name, 0) == 0:
+                    continue
+                open_spans[name] -= 1
+            start = time_us if start is None else min(start, time_us)
+            event = {"name": name, "ph": ph, "ts": time_us, "pid": 0, "tid": core}
+            if ph == "C":
+                event["args"] = {name: arg}
+            else:
+                event["args"] = {"arg": arg}
+                if ph == "i":
+                    event["s"] = "t"
+            out.append(event)
+
+    for event in out:
+        if "ts" in event:
+            event["ts"] -= start
+    return sorted(out, key=lambda e: e.get("ts", -1))
+
+
+def main(argv):
+    here = os.path.dirname(os.path.abspath(__file__))
+    header = os.path.join(here, "..", "non-touch", "trace.h")
+    args = []
+    i = 0
+    while i < len(argv):
+        if argv[i] == "--header":
+            header = argv[i + 1]
+            i += 2
+            continue
+        args.append(argv[i])
+        i += 1
+    if len(args) not in (1, 2):
+        print("usage: trace_decode.py [--header trace.h] trace.bin [trace.json]")
+        return 2
+
+    with open(args[0], "rb") as f:
+        rings = read_rings(f.read())
+    trace = {"traceEvents": chrome_events(rings, event_names(header)), "displayTimeUnit": "ms"}
+
+    if len(args) == 2:
+        with open(args[1], "w") as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+        print()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
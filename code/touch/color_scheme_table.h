@@ -0,0 +1,45 @@
+#ifndef COLOR_SCHEME_TABLE_H
+#define COLOR_SCHEME_TABLE_H
+
+// Palette data shared by colors.c and the build time quantizer (palette_quantizer.cpp).
+// X(scheme, shade 1, shade 2, shade 3, shade 4) -- in COLOR_SCHEMES order
+#define COLOR_SCHEME_TABLE(X) \
+    X(SCHEME_BLACK_AND_WHITE,  0xF7F3F7, 0xB5B2B5, 0x4E4C4E, 0x000000) \
+    X(SCHEME_INVERTED,         0x000000, 0x4E4C4E, 0xB5B2B5, 0xF7F3F7) \
+    X(SCHEME_DMG,              0x7B8210, 0x5A7942, 0x39594A, 0x294139) \
+    X(SCHEME_GAME_BOY_POCKET,  0xC6CBA5, 0x8C926B, 0x4A5139, 0x181818) \
+    X(SCHEME_GAME_BOY_LIGHT,   0x00B284, 0x8C926B, 0x00694A, 0x005139) \
+    X(SCHEME_SGB_1A,           0xF7E3C6, 0xD6924A, 0xA52821, 0x311852) \
+    X(SCHEME_SGB_2A,           0xEFC39C, 0xBD8A4A, 0x297900, 0x000000) \
+    X(SCHEME_SGB_3A,           0xF7CB94, 0x73BABD, 0xF76129, 0x314963) \
+    X(SCHEME_SGB_4A,           0xEFA26B, 0x7BA2F7, 0xCE00CE, 0x00007B) \
+    X(SCHEME_SGB_1B,           0xD6D3BD, 0xC6AA73, 0xAD5110, 0x000000) \
+    X(SCHEME_SGB_2B,           0xF7F3F7, 0xF7E352, 0xF73000, 0x52005A) \
+    X(SCHEME_SGB_3B,           0xD6D3BD, 0xDE8221, 0x005100, 0x001010) \
+    X(SCHEME_SGB_4B,           0xEFE3EF, 0xE79A63, 0x427939, 0x180808) \
+    X(SCHEME_SGB_1C,           0xF7BAF7, 0xE79252, 0x943863, 0x393894) \
+    X(SCHEME_SGB_2C,           0xF7F3F7, 0xE78A8C, 0x7B30E7, 0x292894) \
+    X(SCHEME_SGB_3C,           0xDEA2C6, 0xF7F37B, 0x00B2F7, 0x21205A) \
+    X(SCHEME_SGB_4C,           0xF7DBDE, 0xF7F37B, 0x949ADE, 0x080000) \
+    X(SCHEME_SGB_1D,           0xF7F3A5, 0xBD824A, 0xF70000, 0x521800) \
+    X(SCHEME_SGB_2D,           0xF7F39C, 0x00F300, 0xF73000, 0x000052) \
+    X(SCHEME_SGB_3D,           0xEFF3B5, 0xDEA27B, 0x96AD52, 0x000000) \
+    X(SCHEME_SGB_4D,           0xF7F3B5, 0x94C3C6, 0x4A697B, 0x08204A) \
+    X(SCHEME_SGB_1E,           0xF7D3AD, 0x7BBA7B, 0x6B8A42, 0x5A3821) \
+    X(SCHEME_SGB_2E,           0xF7C384, 0x94AADE, 0x291063, 0x100810) \
+    X(SCHEME_SGB_3E,           0xF7F3BD, 0xDEAA6B, 0xAD7921, 0x524973) \
+    X(SCHEME_SGB_4E,           0xF7D3A5, 0xDEA27B, 0x7B598C, 0x002031) \
+    X(SCHEME_SGB_1F,           0xD6E3F7, 0xDE8A52, 0xA50000, 0x004110) \
+    X(SCHEME_SGB_2F,           0xCEF3F7, 0xF79252, 0x9C0000, 0x180000) \
+    X(SCHEME_SGB_3F,           0x7B79C6, 0xF769F7, 0xF7CB00, 0x424142) \
+    X(SCHEME_SGB_4F,           0xB5CBCE, 0xD682D6, 0x84009C, 0x390000) \
+    X(SCHEME_SGB_1G,           0x000052, 0x009AE7, 0x7B7900, 0xF7F35A) \
+    X(SCHEME_SGB_2G,           0x6BB239, 0xDE5142, 0xDEB284, 0x001800) \
+    X(SCHEME_SGB_3G,           0x63D352, 0xF7F3F7, 0xC63039, 0x390000) \
+    X(SCHEME_SGB_4G,           0xADDB18, 0xB5205A, 0x291000, 0x008263) \
+    X(SCHEME_SGB_1H,           0xF7E3DE, 0xF7B28C, 0x844100, 0x311800) \
+    X(SCHEME_SGB_2H,           0xF7F3F7, 0xB5B2B5, 0x737173, 0x000000) \
+    X(SCHEME_SGB_3H,           0xDEF39C, 0x7BC339, 0x4A8A18, 0x081800) \
+    X(SCHEME_SGB_4H,           0xF7F3C6, 0xB5BA5A, 0x848A42, 0x425129)
+
+#endif // COLOR_SCHEME_TABLE_H
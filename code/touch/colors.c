@@ -1,45 +1,15 @@
+#include <string.h>
 #include "colors.h"
 #include "pico/scanvideo.h"
+#include "color_scheme_table.h"
+#include "dot_matrix.h"
+#include "ambient.h"
+
+#define COLOR_SCHEME_ENTRY(scheme, c1, c2, c3, c4)  [scheme] = { c1, c2, c3, c4 },
 
 static color_scheme_t color_schemes[NUMBER_OF_SCHEMES] = 
 {
-    [SCHEME_BLACK_AND_WHITE] =  { 0xF7F3F7, 0xB5B2B5, 0x4E4C4E, 0x000000 },
-    [SCHEME_INVERTED] =         { 0x000000, 0x4E4C4E, 0xB5B2B5, 0xF7F3F7 },
-    [SCHEME_DMG] =              { 0x7B8210, 0x5A7942, 0x39594A, 0x294139 },
-    [SCHEME_GAME_BOY_POCKET] =  { 0xC6CBA5, 0x8C926B, 0x4A5139, 0x181818 },
-    [SCHEME_GAME_BOY_LIGHT] =   { 0x00B284, 0x8C926B, 0x00694A, 0x005139 },
-    [SCHEME_SGB_1A] =           { 0xF7E3C6, 0xD6924A, 0xA52821, 0x311852 },
-    [SCHEME_SGB_2A] =           { 0xEFC39C, 0xBD8A4A, 0x297900, 0x000000 },
-    [SCHEME_SGB_3A] =           { 0xF7CB94, 0x73BABD, 0xF76129, 0x314963 },
-    [SCHEME_SGB_4A] =           { 0xEFA26B, 0x7BA2F7, 0xCE00CE, 0x00007B },
-    [SCHEME_SGB_1B] =           { 0xD6D3BD, 0xC6AA73, 0xAD5110, 0x000000 },
-    [SCHEME_SGB_2B] =           { 0xF7F3F7, 0xF7E352, 0xF73000, 0x52005A },
-    [SCHEME_SGB_3B] =           { 0xD6D3BD, 0xDE8221, 0x005100, 0x001010 },
-    [SCHEME_SGB_4B] =           { 0xEFE3EF, 0xE79A63, 0x427939, 0x180808 },
-    [SCHEME_SGB_1C] =           { 0xF7BAF7, 0xE79252, 0x943863, 0x393894 },
-    [SCHEME_SGB_2C] =           { 0xF7F3F7, 0xE78A8C, 0x7B30E7, 0x292894 },
-    [SCHEME_SGB_3C] =           { 0xDEA2C6, 0xF7F37B, 0x00B2F7, 0x21205A },
-    [SCHEME_SGB_4C] =           { 0xF7DBDE, 0xF7F37B, 0x949ADE, 0x080000 },
-    [SCHEME_SGB_1D] =           { 0xF7F3A5, 0xBD824A, 0xF70000, 0x521800 },
-    [SCHEME_SGB_2D] =           { 0xF7F39C, 0x00F300, 0xF73000, 0x000052 },
-    [SCHEME_SGB_3D] =           { 0xEFF3B5, 0xDEA27B, 0x96AD52, 0x000000 },
-    [SCHEME_SGB_4D] =           { 0xF7F3B5, 0x94C3C6, 0x4A697B, 0x08204A },
-    [SCHEME_SGB_1E] =           { 0xF7D3AD, 0x7BBA7B, 0x6B8A42, 0x5A3821 },
-    [SCHEME_SGB_2E] =           { 0xF7C384, 0x94AADE, 0x291063, 0x100810 },
-    [SCHEME_SGB_3E] =           { 0xF7F3BD, 0xDEAA6B, 0xAD7921, 0x524973 },
-    [SCHEME_SGB_4E] =           { 0xF7D3A5, 0xDEA27B, 0x7B598C, 0x002031 },
-    [SCHEME_SGB_1F] =           { 0xD6E3F7, 0xDE8A52, 0xA50000, 0x004110 },
-    [SCHEME_SGB_2F] =           { 0xCEF3F7, 0xF79252, 0x9C0000, 0x180000 },
-    [SCHEME_SGB_3F] =           { 0x7B79C6, 0xF769F7, 0xF7CB00, 0x424142 },
-    [SCHEME_SGB_4F] =           { 0xB5CBCE, 0xD682D6, 0x84009C, 0x390000 },
-    [SCHEME_SGB_1G] =           { 0x000052, 0x009AE7, 0x7B7900, 0xF7F35A },
-    [SCHEME_SGB_2G] =           { 0x6BB239, 0xDE5142, 0xDEB284, 0x001800 },
-    [SCHEME_SGB_3G] =           { 0x63D352, 0xF7F3F7, 0xC63039, 0x390000 },
-    [SCHEME_SGB_4G] =           { 0xADDB18, 0xB5205A, 0x291000, 0x008263 },
-    [SCHEME_SGB_1H] =           { 0xF7E3DE, 0xF7B28C, 0x844100, 0x311800 },
-    [SCHEME_SGB_2H] =           { 0xF7F3F7, 0xB5B2B5, 0x737173, 0x000000 },
-    [SCHEME_SGB_3H] =           { 0xDEF39C, 0x7BC339, 0x4A8A18, 0x081800 },
-    [SCHEME_SGB_4H] =           { 0xF7F3C6, 0xB5BA5A, 0x848A42, 0x425129 }
+    COLOR_SCHEME_TABLE(COLOR_SCHEME_ENTRY)
 };
 
 static uint32_t basic_colors[NUMBER_OF_COLORS] = 
@@ -63,10 +33,51 @@ static control_scheme_t control_schemes[NUMBER_OF_CONTROL_SCHEMES] =
     [CONTROL_SCHEME_GREY2] =    { 0x808080, 0x404040, 0xFF0000, 0xFFFF00 },
 };
 
+// 2x2 ordered pattern so neighbouring pixels never share a dither phase
+const uint8_t frc_bayer[2][2] = 
+{
+    { 0, 2 },
+    { 3, 1 }
+};
+
+// Palette tokens for each region, dither phase and (previous, current) shade
+// pair, rebuilt only when the palette or blend settings change.  Read for
+// every game pixel, so kept in core1's scratch bank (SRAM4).  Double
+// buffered like the palette layouts so a scheme change never shows a line
+// drawn from a half built table -- as long as builds are a line apart, so
+// changes that come together (set_palette) build once.
+typedef uint16_t scheme_luts_t[PALETTE_REGIONS][FRC_PHASES][SCHEME_LUT_SIZE];
+
+static scheme_luts_t __scratch_x("scheme_luts") scheme_lut_buffers[2];
+static scheme_luts_t* volatile scheme_luts = &scheme_lut_buffers[0];
+static bool dither_enabled = false;
+static int blend_level = 0;
+
 static int border_color_index = 0;
 static int color_scheme_index = SCHEME_BLACK_AND_WHITE;    // TODO... color "scheme" offset?
 static int control_scheme_index = CONTROL_SCHEME_DEFAULT;
 
+static palette_region_t palette_regions[PALETTE_REGIONS] = 
+{
+    [1] = { .scheme = PALETTE_REGION_OFF, .first_line = 128, .last_line = 143 },
+    [2] = { .scheme = PALETTE_REGION_OFF, .first_line = 0, .last_line = 15 },
+};
+
+// Segment lists for each output line.  Sideways orientations share one list
+// split along the line; the others point each line at a whole line list for
+// its region.  Double buffered so core1 never walks a list while it is being
+// rebuilt.
+typedef struct palette_layout_t
+{
+    palette_segments_t along_line;
+    palette_segments_t whole_line[PALETTE_REGIONS];
+    const palette_segments_t* lines[PALETTE_REGION_WIDTH];
+} palette_layout_t;
+
+static orientation_t palette_orientation = ORIENTATION_270;
+static palette_layout_t palette_layouts[2];
+static palette_layout_t* volatile palette_layout = NULL;
+
 uint32_t get_basic_color(uint8_t index)
 {
     return basic_colors[index];
@@ -100,6 +111,16 @@ void change_color_scheme_index(int direction)
     color_scheme_index += direction;
     color_scheme_index = color_scheme_index >= NUMBER_OF_SCHEMES ? 0 : color_scheme_index;
     color_scheme_index = color_scheme_index < 0 ? (NUMBER_OF_SCHEMES-1) : color_scheme_index;
+    build_scheme_luts();
+}
+
+void set_color_scheme_index(int index)
+{
+    if (index < 0 || index >= NUMBER_OF_SCHEMES)
+        return;
+
+    color_scheme_index = index;
+    build_scheme_luts();
 }
 
 void change_control_scheme_index(int direction)
@@ -129,10 +150,253 @@ int get_control_scheme_index(void)
     return control_scheme_index;
 }
 
-uint16_t rgb888_to_rgb222(uint32_t color)
+uint16_t __not_in_flash_func(rgb888_to_rgb222)(uint32_t color)
 {
     uint32_t red = (color & 0xC00000) >> 22;
     uint32_t green = (color & 0xC000) >> 14;
     uint32_t blue = (color & 0xC0) >> 6;
     return (uint16_t)( ( blue<<PICO_SCANVIDEO_PIXEL_BSHIFT ) |( green<<PICO_SCANVIDEO_PIXEL_GSHIFT ) |( red<<PICO_SCANVIDEO_PIXEL_RSHIFT ) );
+}
+
+// Nearest RGB222 level (0..3) for an 8 bit channel, biased up to the next
+// level on phases below the channel's remainder.  Levels are 0, 85, 170, 255.
+static uint8_t frc_channel(uint8_t value, uint8_t phase)
+{
+    uint8_t level = value / 85;
+    uint8_t remainder = value - (level * 85);
+    uint8_t high_phases = ((remainder * FRC_PHASES) + 42) / 85;
+
+    if (level < 3 && phase < high_phases)
+        level++;
+
+    return level;
+}
+
+static uint16_t rgb888_to_rgb222_frc(uint32_t color, uint8_t phase)
+{
+    uint32_t red = frc_channel((color >> 16) & 0xFF, phase);
+    uint32_t green = frc_channel((color >> 8) & 0xFF, phase);
+    uint32_t blue = frc_channel(color & 0xFF, phase);
+    return (uint16_t)( ( blue<<PICO_SCANVIDEO_PIXEL_BSHIFT ) |( green<<PICO_SCANVIDEO_PIXEL_GSHIFT ) |( red<<PICO_SCANVIDEO_PIXEL_RSHIFT ) );
+}
+
+static uint32_t blend_rgb888(uint32_t current, uint32_t previous, int level)
+{
+    uint32_t blended = 0;
+    for (int shift = 0; shift < 24; shift += 8)
+    {
+        uint32_t c = (current >> shift) & 0xFF;
+        uint32_t p = (previous >> shift) & 0xFF;
+        blended |= (((c * (BLEND_LEVELS - level)) + (p * level)) / BLEND_LEVELS) << shift;
+    }
+    return blended;
+}
+
+static int region_scheme(uint8_t region)
+{
+    return region == 0 ? color_scheme_index : palette_regions[region].scheme;
+}
+
+// 24 bit color shown for a framebuffer pixel (shade pair) at the current blend level
+uint32_t get_region_pixel_color(uint8_t region, uint8_t pixel)
+{
+    uint32_t* colors = (uint32_t*)&color_schemes[region_scheme(region)];
+    return blend_rgb888(colors[SHADE_CURRENT(pixel)], colors[SHADE_PREVIOUS(pixel)], blend_level);
+}
+
+uint32_t get_scheme_pixel_color(uint8_t pixel)
+{
+    return get_region_pixel_color(0, pixel);
+}
+
+uint16_t rgb888_to_scheme_token(uint32_t color, uint8_t phase)
+{
+    return dither_enabled ? rgb888_to_rgb222_frc(color, phase) : rgb888_to_rgb222_nearest(color);
+}
+
+void build_scheme_luts(void)
+{
+    scheme_luts_t* luts = (scheme_luts == &scheme_lut_buffers[0]) ? &scheme_lut_buffers[1] : &scheme_lut_buffers[0];
+
+    for (int region = 0; region < PALETTE_REGIONS; region++)
+    {
+        int scheme = region_scheme(region);
+        if (scheme == PALETTE_REGION_OFF)
+            continue;
+
+        for (int phase = 0; phase < FRC_PHASES; phase++)
+        {
+            // without dither every phase is the generated tokens, with only
+            // blended shade pairs converted
+            if (!dither_enabled && phase > 0)
+            {
+                memcpy((*luts)[region][phase], (*luts)[region][0], sizeof((*luts)[region][0]));
+                continue;
+            }
+
+            for (int pixel = 0; pixel < SCHEME_LUT_SIZE; pixel++)
+            {
+                uint8_t current = SHADE_CURRENT(pixel);
+
+                if (!dither_enabled && (current == SHADE_PREVIOUS(pixel) || blend_level == 0))
+                    (*luts)[region][phase][pixel] = quantized_scheme_tokens[scheme][current];
+                else
+                    (*luts)[region][phase][pixel] = rgb888_to_scheme_token(get_region_pixel_color(region, pixel), phase);
+            }
+        }
+    }
+    scheme_luts = luts;
+
+    build_ambient_lut();
+
+#ifdef DOT_MATRIX_MODE
+    build_dot_matrix_templates();
+#endif
+}
+
+const uint16_t* __not_in_flash_func(get_scheme_lut)(uint8_t phase)
+{
+    return get_region_lut(0, phase);
+}
+
+const uint16_t* __not_in_flash_func(get_region_lut)(uint8_t region, uint8_t phase)
+{
+    return (*scheme_luts)[region][phase & (FRC_PHASES-1)];
+}
+
+// Paints each region's DMG lines in order, maps them to output positions or
+// output lines, then collapses them into segments
+static void build_palette_segments(void)
+{
+    static uint8_t line_region[PALETTE_REGION_LINES];
+    static uint8_t out_region[PALETTE_REGION_WIDTH];
+    palette_layout_t* layout = (palette_layout == &palette_layouts[0]) ? &palette_layouts[1] : &palette_layouts[0];
+    bool sideways = ORIENTATION_IS_SIDEWAYS(palette_orientation);
+    uint8_t out_width = ORIENTATION_OUT_WIDTH(palette_orientation, PALETTE_REGION_WIDTH, PALETTE_REGION_LINES);
+    uint8_t out_lines = ORIENTATION_OUT_HEIGHT(palette_orientation, PALETTE_REGION_WIDTH, PALETTE_REGION_LINES);
+
+    memset(line_region, 0, sizeof(line_region));
+    for (int region = 1; region < PALETTE_REGIONS; region++)
+    {
+        const palette_region_t* config = &palette_regions[region];
+        if (config->scheme == PALETTE_REGION_OFF)
+            continue;
+
+        for (int line = config->first_line; line <= config->last_line && line < PALETTE_REGION_LINES; line++)
+            line_region[line] = region;
+    }
+
+    // a DMG line is a position on every output line, or a whole output line
+    for (int line = 0; line < PALETTE_REGION_LINES; line++)
+    {
+        int32_t index = orientation_index(palette_orientation, 0, line, PALETTE_REGION_WIDTH, PALETTE_REGION_LINES);
+        out_region[sideways ? (index % out_width) : (index / out_width)] = line_region[line];
+    }
+
+    for (int region = 0; region < PALETTE_REGIONS; region++)
+    {
+        layout->whole_line[region].count = 1;
+        layout->whole_line[region].segments[0] = (palette_segment_t){ .start = 0, .end = out_width, .region = region };
+    }
+
+    if (sideways)
+    {
+        palette_segments_t* segments = &layout->along_line;
+        palette_segment_t* segment = segments->segments;
+        segment->start = 0;
+        segment->region = out_region[0];
+        for (int pos = 1; pos < out_width; pos++)
+        {
+            if (out_region[pos] != segment->region)
+            {
+                segment->end = pos;
+                segment++;
+                segment->start = pos;
+                segment->region = out_region[pos];
+            }
+        }
+        segment->end = out_width;
+        segments->count = segment - segments->segments + 1;
+    }
+
+    for (int line = 0; line < PALETTE_REGION_WIDTH; line++)
+    {
+        if (sideways)
+            layout->lines[line] = &layout->along_line;
+        else
+            layout->lines[line] = &layout->whole_line[line < out_lines ? out_region[line] : 0];
+    }
+
+    palette_layout = layout;
+}
+
+const palette_region_t* get_palette_region(uint8_t region)
+{
+    return &palette_regions[region];
+}
+
+static void store_palette_region(uint8_t region, const palette_region_t* config)
+{
+    palette_regions[region] = *config;
+    if (palette_regions[region].first_line > palette_regions[region].last_line)
+        palette_regions[region].last_line = palette_regions[region].first_line;
+}
+
+void set_palette_region(uint8_t region, const palette_region_t* config)
+{
+    if (region == 0 || region >= PALETTE_REGIONS)
+        return;
+
+    store_palette_region(region, config);
+    build_scheme_luts();
+    build_palette_segments();
+}
+
+// Scheme and regions 1.. together, as a saved profile holds them, with the
+// tables built once.
+void set_palette(int scheme, const palette_region_t* regions)
+{
+    if (scheme >= 0 && scheme < NUMBER_OF_SCHEMES)
+        color_scheme_index = scheme;
+
+    for (int region = 1; region < PALETTE_REGIONS; region++)
+        store_palette_region(region, &regions[region - 1]);
+
+    build_scheme_luts();
+    build_palette_segments();
+}
+
+void set_palette_orientation(orientation_t orientation)
+{
+    palette_orientation = orientation;
+    build_palette_segments();
+}
+
+const palette_segments_t* __not_in_flash_func(get_palette_segments)(uint8_t line_index)
+{
+    return palette_layout->lines[line_index];
+}
+
+bool get_dither_enabled(void)
+{
+    return dither_enabled;
+}
+
+void set_dither_enabled(bool enabled)
+{
+    dither_enabled = enabled;
+    build_scheme_luts();
+}
+
+int get_blend_percent(void)
+{
+    return (blend_level * 100) / BLEND_LEVELS;
+}
+
+void change_blend_level(int direction)
+{
+    blend_level += direction;
+    blend_level = blend_level >= BLEND_LEVELS ? 0 : blend_level;
+    blend_level = blend_level < 0 ? (BLEND_LEVELS-1) : blend_level;
+    build_scheme_luts();
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define COLORS_H
 
 #include "pico/stdlib.h"
+#include "orientation.h"
 
 typedef enum
 {
@@ -54,6 +55,58 @@ typedef struct color_scheme_t
     uint32_t c4;
 } color_scheme_t;
 
+// Frame rate control (temporal dithering) phases.  Each palette color is
+// approximated by alternating between the two nearest RGB222 levels.
+#define FRC_PHASES          (4)
+#define FRC_PHASE(x, y, frame)  ((frc_bayer[(y) & 1][(x) & 1] + (frame)) & (FRC_PHASES-1))
+
+extern const uint8_t frc_bayer[2][2];
+
+// Framebuffer pixels hold the current shade in bits 0-1 and the previous
+// frame's shade in bits 2-3.  Scheme LUTs are indexed by the whole byte so
+// frame blending costs nothing extra when rendering.
+#define SHADE_CURRENT(pixel)    ((pixel) & 0x03)
+#define SHADE_PREVIOUS(pixel)   (((pixel) >> 2) & 0x03)
+#define SHADE_PUSH(pixel, shade) ((((pixel) << 2) & 0x0C) | (shade))
+#define SCHEME_LUT_SIZE         (16)
+#define BLEND_LEVELS            (4)     // 0%, 25%, 50%, 75% of the previous frame
+
+// Palette regions -- like SGB attribute blocks, a range of DMG lines (a
+// status bar, say) can use its own scheme.  Region 0 is the whole screen in
+// the main scheme and later regions are drawn over it.  Sideways
+// orientations put every DMG line across each output line, the others give
+// each output line a single DMG line, so the configuration is resolved into
+// a segment list per output line whenever it or the orientation changes.
+#define PALETTE_REGIONS         (3)
+#define PALETTE_REGION_OFF      (-1)
+#define PALETTE_REGION_LINES    (144)   // DMG_PIXELS_Y
+#define PALETTE_REGION_WIDTH    (160)   // DMG_PIXELS_X
+#define PALETTE_SEGMENTS_MAX    (2 * PALETTE_REGIONS - 1)
+
+typedef struct palette_region_t
+{
+    int8_t scheme;          // PALETTE_REGION_OFF when unused
+    uint8_t first_line;
+    uint8_t last_line;
+} palette_region_t;
+
+typedef struct palette_segment_t
+{
+    uint8_t start;
+    uint8_t end;            // exclusive
+    uint8_t region;
+} palette_segment_t;
+
+typedef struct palette_segments_t
+{
+    uint8_t count;
+    palette_segment_t segments[PALETTE_SEGMENTS_MAX];
+} palette_segments_t;
+
+// Perceptually nearest distinct RGB222 tokens per scheme (palette_quantizer.cpp).
+// The scheme LUTs are copied from these unless FRC dithering is turned on.
+extern const uint16_t quantized_scheme_tokens[NUMBER_OF_SCHEMES][4];
+
 typedef enum
 {
     COLOR_BLACK = 0,
@@ -90,11 +143,28 @@ int get_border_color_index(void);
 void change_border_color_index(int direction);
 void set_background_color(int index);
 void change_color_scheme_index(int direction);
+void set_color_scheme_index(int index);
 void change_control_scheme_index(int direction);
 color_scheme_t* get_scheme(void);
 control_scheme_t* get_control_scheme(void);
 int get_scheme_index(void);
 int get_control_scheme_index(void);
 uint16_t rgb888_to_rgb222(uint32_t color);
+void build_scheme_luts(void);
+const uint16_t* get_scheme_lut(uint8_t phase);
+const uint16_t* get_region_lut(uint8_t region, uint8_t phase);
+const palette_region_t* get_palette_region(uint8_t region);
+void set_palette_region(uint8_t region, const palette_region_t* config);
+void set_palette(int scheme, const palette_region_t* regions);
+void set_palette_orientation(orientation_t orientation);
+const palette_segments_t* get_palette_segments(uint8_t line_index);
+bool get_dither_enabled(void);
+void set_dither_enabled(bool enabled);
+int get_blend_percent(void);
+void change_blend_level(int direction);
+uint16_t rgb888_to_rgb222_nearest(uint32_t color);
+uint32_t get_scheme_pixel_color(uint8_t pixel);
+uint32_t get_region_pixel_color(uint8_t region, uint8_t pixel);
+uint16_t rgb888_to_scheme_token(uint32_t color, uint8_t phase);
 
 #endif // COLORS_H
\ No newline at end of file
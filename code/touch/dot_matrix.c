@@ -0,0 +1,68 @@
+#include "dot_matrix.h"
+
+#ifdef DOT_MATRIX_MODE
+
+// Double buffered like the scheme LUTs:  core1 keeps drawing from the
+// current templates while the other buffer is rebuilt.
+typedef dot_template_t dot_matrix_templates_t[PALETTE_REGIONS][FRC_PHASES][DOT_ROW_KINDS][SCHEME_LUT_SIZE];
+
+static dot_matrix_templates_t dot_matrix_template_buffers[2];
+static dot_matrix_templates_t* volatile dot_matrix_templates = &dot_matrix_template_buffers[0];
+static bool dot_grid_enabled = true;
+
+// Gap pixels are the same color at half brightness
+static uint32_t gap_color(uint32_t color)
+{
+    return (color >> 1) & 0x7F7F7F;
+}
+
+void build_dot_matrix_templates(void)
+{
+    dot_matrix_templates_t* templates = (dot_matrix_templates == &dot_matrix_template_buffers[0]) ? &dot_matrix_template_buffers[1] : &dot_matrix_template_buffers[0];
+
+    for (int region = 0; region < PALETTE_REGIONS; region++)
+    {
+        if (region > 0 && get_palette_region(region)->scheme == PALETTE_REGION_OFF)
+            continue;
+
+        for (int phase = 0; phase < FRC_PHASES; phase++)
+        {
+            const uint16_t* lut = get_region_lut(region, phase);
+            for (int pixel = 0; pixel < SCHEME_LUT_SIZE; pixel++)
+            {
+                uint16_t lit = lut[pixel];
+                uint16_t gap = dot_grid_enabled ? rgb888_to_scheme_token(gap_color(get_region_pixel_color(region, pixel)), phase) : lit;
+
+                dot_template_t* t = &(*templates)[region][phase][DOT_ROW_PIXEL][pixel];
+                (*t)[0] = lit;
+                (*t)[1] = lit;
+                (*t)[2] = gap;
+
+                t = &(*templates)[region][phase][DOT_ROW_GAP][pixel];
+                (*t)[0] = gap;
+                (*t)[1] = gap;
+                (*t)[2] = gap;
+            }
+        }
+    }
+    dot_matrix_templates = templates;
+}
+
+const dot_template_t* __not_in_flash_func(get_dot_matrix_templates)(uint8_t region, uint8_t phase, uint8_t sub_row)
+{
+    dot_row_t kind = sub_row == (DOT_MATRIX_TOKENS - 1) ? DOT_ROW_GAP : DOT_ROW_PIXEL;
+    return (*dot_matrix_templates)[region][phase & (FRC_PHASES-1)][kind];
+}
+
+bool get_dot_grid_enabled(void)
+{
+    return dot_grid_enabled;
+}
+
+void set_dot_grid_enabled(bool enabled)
+{
+    dot_grid_enabled = enabled;
+    build_dot_matrix_templates();
+}
+
+#endif // DOT_MATRIX_MODE
@@ -21,12 +21,27 @@
 #include "osd.h"
 #include "hardware/i2c.h"
 #include "hardware/pwm.h"
+#include "hardware/structs/systick.h"
 #include "colors.h"
+#include "dot_matrix.h"
+#include "game_span.h"
+#include "artwork.h"
+#include "layout.h"
+#include "ambient.h"
+#include "settings.h"
+#include "fingerprint.h"
+#include "render_stats.h"
+#include "capture_stats.h"
+#include "trace.h"
+#include "telemetry.h"
+#include "latency.h"
+#include "orientation.h"
 #include "touch.h"
 
 
 #define SDA_PIN                     12
 #define SCL_PIN                     13
+#define TOUCH_INT_PIN               28      // GT911 INT, falls when a report is ready
 i2c_inst_t* i2cHandle = i2c0;
 
 #define TOUCH_INTERFACE
@@ -52,6 +67,19 @@ i2c_inst_t* i2cHandle = i2c0;
 #define DATA_0_PIN                  15
 #define DATA_1_PIN                  14
 
+// DATA 0 is the pin above DATA 1, so one read of the GPIO inputs gives the
+// shade as (DATA 0 << 1) + DATA 1 with a shift and a mask
+_Static_assert(DATA_0_PIN == DATA_1_PIN + 1, "capture reads DATA 0/1 as adjacent pins");
+#define CAPTURE_SHADE(gpio_in)      (((gpio_in) >> DATA_1_PIN) & 3)
+
+// Capture waits give up after this many spins (a GPIO read, test and count,
+// about 6 cycles at 240 MHz).  A pixel is ~57 cycles and the pixel clock
+// pauses for ~60us between lines; HSYNC is low for most of a 109us line.
+#define CAPTURE_SPINS_PER_US            (40)
+#define CAPTURE_PIXEL_TIMEOUT_SPINS     (10 * CAPTURE_SPINS_PER_US)
+#define CAPTURE_HSYNC_TIMEOUT_SPINS     (250 * CAPTURE_SPINS_PER_US)
+#define SYSTICK_MASK                    (0x00FFFFFF)
+
 // at 3x Game area will be 480x432 
 #define DMG_PIXELS_X                160
 #define DMG_PIXELS_Y                144
@@ -74,12 +102,54 @@ typedef enum
 typedef enum
 {
     OSD_LINE_COLOR_SCHEME = 0,
+    OSD_LINE_REGION,
+    OSD_LINE_REGION_SCHEME,
+    OSD_LINE_REGION_FIRST,
+    OSD_LINE_REGION_LAST,
     OSD_LINE_BACK_COLOR,
+    OSD_LINE_DITHER,
+    OSD_LINE_BLEND,
+#ifdef DOT_MATRIX_MODE
+    OSD_LINE_DOT_GRID,
+#endif
+    OSD_LINE_SKIN,
+    OSD_LINE_LAYOUT,
+    OSD_LINE_AMBIENT,
+    OSD_LINE_ORIENTATION,
     OSD_LINE_BACKLIGHT,
+    OSD_LINE_PERF_HUD,
     OSD_LINE_EXIT,
     OSD_LINE_COUNT
 } osd_line_t;
 
+typedef enum
+{
+    OSD_PAGE_SETTINGS = 0,
+    OSD_PAGE_PERF,
+    OSD_PAGE_COUNT
+} osd_page_t;
+
+typedef enum
+{
+    HUD_LINE_IN_FPS = 0,
+    HUD_LINE_OUT_FPS,
+    HUD_LINE_DROPPED,
+    HUD_LINE_REPEATED,
+    HUD_LINE_JITTER,
+    HUD_LINE_CAPTURE_ERRORS,
+    HUD_LINE_HEADROOM_GAME,
+    HUD_LINE_HEADROOM_OSD,
+    HUD_LINE_HEADROOM_CONTROLS,
+    HUD_LINE_MISSED,
+    HUD_LINE_CORE0,
+    HUD_LINE_CORE1,
+    HUD_LINE_BACK,
+    HUD_LINE_COUNT
+} hud_line_t;
+
+_Static_assert(OSD_LINE_COUNT <= OSD_LINES && HUD_LINE_COUNT <= OSD_LINES, "OSD page has more lines than the OSD");
+_Static_assert(OSD_PAGE_COUNT <= OSD_PAGES, "more OSD pages than the OSD keeps");
+
 const scanvideo_timing_t vga_timing_800x480 =
 {
         .clock_freq = 24000000,
@@ -113,6 +183,16 @@ const scanvideo_mode_t vga_mode_tft_800x480_3x_scale =
         .yscale = 3,
 };
 
+const scanvideo_mode_t vga_mode_tft_800x480_1x_scale =
+{
+        .default_timing = &vga_timing_800x480,
+        .pio_program = &video_24mhz_composable,
+        .width = 800,
+        .height = 480,
+        .xscale = 1,
+        .yscale = 1,
+};
+
 typedef struct rectangle_t
 {
     uint16_t x;
@@ -127,50 +207,145 @@ typedef enum
     BUTTON_STATE_UNPRESSED
 } button_state_t;
 
+// How much of a scanline is composited when render is behind the beam
+typedef enum
+{
+    RENDER_FULL = 0,
+    RENDER_GAME_ONLY,       // game pixels on a plain border -- no OSD or artwork
+    RENDER_SOLID            // background color only
+} render_level_t;
+
+typedef struct render_health_t
+{
+    uint32_t degraded_frames;   // frames that fell back to RENDER_GAME_ONLY
+    uint32_t degraded_lines;
+    uint32_t solid_lines;       // lines already due when generation started
+    uint32_t output_frames;     // panel frames
+    uint32_t dropped_frames;    // captured frames the panel never started a frame on
+    uint32_t repeated_frames;   // panel frames started with no new capture
+} render_health_t;
+
+// Counters as they were when the performance page was opened or its rates
+// last worked out
+typedef struct perf_snapshot_t
+{
+    uint32_t time_us;
+    uint32_t output_frames;
+    uint32_t dropped_frames;
+    uint32_t repeated_frames;
+    uint32_t capture_errors;
+    uint32_t capture_busy_us;
+    uint32_t render_busy_cycles;
+} perf_snapshot_t;
+
+#ifdef DOT_MATRIX_MODE
+#define VGA_MODE        vga_mode_tft_800x480_1x_scale
+#define DMG_PIXEL_TOKENS    DOT_MATRIX_TOKENS   // output pixels (and lines) per DMG pixel
+#define GAME_SPAN       dot_matrix_span
+#else
 #define VGA_MODE        vga_mode_tft_800x480_3x_scale
+#define DMG_PIXEL_TOKENS    1
+#define GAME_SPAN       game_span
+#endif
 #define LINE_LENGTH     ((uint16_t)(((VGA_MODE.width * 100.0)/VGA_MODE.xscale) + 50) / 100)
+#define SCANLINES_PER_FRAME     (VGA_MODE.height / VGA_MODE.yscale)
+
+// Scanlines are generated ahead of the beam.  With fewer than this many
+// lines of lead the rest of the frame is rendered RENDER_GAME_ONLY.
+#define RENDER_LEAD_MIN         (2)
+
+// Performance page rates are worked out over this long; with no capture the
+// page still refreshes every PERF_HUD_IDLE_US
+#define PERF_WINDOW_US          (1000000)
+#define PERF_HUD_IDLE_US        (100000)
+
+// Panel mounting, set with GAMEBOY_XL_ORIENTATION -- also selectable in the OSD
+#ifndef DEFAULT_ORIENTATION
+#define DEFAULT_ORIENTATION     ORIENTATION_270
+#endif
 
 static rectangle_t rect_gamewindow;
 static rectangle_t rect_osd;
+static orientation_t orientation = DEFAULT_ORIENTATION;
+static bool (* volatile capture_kernel)(void) = NULL;
+static volatile render_health_t render_health;
+
+static uint32_t vsync_period_us;
+static volatile uint32_t capture_busy_us;   // in the capture interrupt, never reset
+
+volatile capture_stats_t capture_stats =
+{
+    .pixels_min = DMG_PIXELS_X,
+#ifdef CAPTURE_SLACK_STATS
+    .slack_min = UINT32_MAX,
+#endif
+};
+
+#define ORIENTATION_LABEL(name, label)  [name] = label,
+static const char* orientation_labels[ORIENTATION_COUNT] = 
+{
+    ORIENTATION_TABLE(ORIENTATION_LABEL)
+};
 static uint16_t background_color;
 static int backlight_level = 10;    // 1 to 10
 
+#define PALETTE_REGION_STEP     8       // region edges move a DMG tile row at a time
+static uint8_t edit_region = 1;         // palette region shown in the OSD
+static uint32_t game_id = SETTINGS_DEFAULT_GAME;
+static bool settings_dirty = false;
+
 static semaphore_t video_initted;
 static uint8_t button_states[BUTTON_COUNT];
 static uint8_t button_states_previous[BUTTON_COUNT];
-static color_scheme_t* color_scheme;
 static control_scheme_t* control_scheme;
 
-static uint8_t framebuffer[DMG_PIXEL_COUNT];
+static uint8_t framebuffer[DMG_PIXEL_COUNT] __attribute__((aligned(4)));   // rows are whole words in every orientation
 static uint8_t* osd_framebuffer = NULL;
 
-// The controls buffer is a 160x120 area at 10x scale
-static uint8_t framebuffer_controls_8bit[] = 
-{
-    0,1,1,0,0,0,0,1,1,0,0,0,0,1,1,0,
-    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-    0,0,0,1,1,0,0,0,0,0,0,0,0,2,2,0,
-    0,0,0,1,1,0,0,0,0,0,0,0,0,2,2,0,
-    0,1,1,0,0,1,1,0,0,0,2,2,0,0,0,0,
-    0,1,1,0,0,1,1,0,0,0,2,2,0,0,0,0,
-    0,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,
-    0,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,
-    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-};
+// The controls panel is the right of the 3x scale grid, cut into cells of
+// CONTROLS_SCALE pixels square.  Output line groups run down the panel, and
+// cells across each line from the game window.
+#define CONTROLS_COLUMNS            16
+#define CONTROLS_ROWS               12
+#define CONTROLS_SCALE              10
+#define CONTROLS_LINE_GROUPS        CONTROLS_COLUMNS    // ROTATE 270 -- art columns run down the panel
+#define CONTROLS_MAX_SPANS          CONTROLS_ROWS
+#define TOUCH_AREA_SCALE            3                   // touches go to the 3x scale grid in either mode
+
+#define BUTTON_BIT(button)          (1u << (button))
+
+// The current layout (see layout.h) cell by cell:  a touch is one lookup,
+// and the cells with a color are the controls art.  Cells with no area are
+// dead.
+static uint16_t controls_grid[CONTROLS_LINE_GROUPS][CONTROLS_ROWS];
+static uint8_t controls_cells = CONTROLS_ROWS;             // of the grid on the panel, set
+static uint8_t controls_groups = CONTROLS_LINE_GROUPS;     // by the orientation
+static uint8_t controls_grid_color[CONTROLS_LINE_GROUPS][CONTROLS_ROWS];   // layout_color_t
+static uint16_t button_line_groups[BUTTON_COUNT];      // bit per group the button is on
+static layout_calibration_t touch_calibration;
+
+// Buttons under each touch point, by track id.  A button is held while any
+// point is on it.
+static uint16_t touch_buttons[MAX_TOUCH_POINTS];
+
+// Controls panel pre-rendered as button spans drawn over the artwork, one
+// span list per group of CONTROLS_SCALE output lines.  Each group is double
+// buffered, and a rebuild writes the buffer core1 was reading before the
+// last swap -- so button changes only mark their groups dirty, and a dirty
+// group is rebuilt at most once per output frame, by when core1 has moved
+// on from the older buffer.
+typedef struct controls_line_t
+{
+    uint8_t span_count;
+    artwork_span_t spans[CONTROLS_MAX_SPANS];
+} controls_line_t;
 
-// Touch areas for buttons
-static const rectangle_t scaled_home   = {.x = 146, .y = 70,  .width = 10, .height = 20};
-static const rectangle_t scaled_start  = {.x = 146, .y = 10,  .width = 10, .height = 20}; 
-static const rectangle_t scaled_select = {.x = 146, .y = 130, .width = 10, .height = 20};
-static const rectangle_t scaled_a      = {.x = 186,  .y = 10, .width = 20, .height = 20};       // maybe x 183... 
-static const rectangle_t scaled_b      = {.x = 206,  .y = 40, .width = 20, .height = 20};       // maybe x 203...
-static const rectangle_t scaled_up     = {.x = 186,  .y = 110,  .width = 20, .height = 20};     // maybe x 183...
-static const rectangle_t scaled_down   = {.x = 226,  .y = 110,  .width = 20, .height = 20};     // maybe x 223...
-static const rectangle_t scaled_left   = {.x = 206,  .y = 130,  .width = 20, .height = 20};     // maybe x 203...
-static const rectangle_t scaled_right  = {.x = 206,  .y = 90,  .width = 20, .height = 20};      // maybe x 203...
+static controls_line_t controls_line_buffers[CONTROLS_LINE_GROUPS][2];
+static controls_line_t* volatile controls_lines[CONTROLS_LINE_GROUPS];
+static uint16_t controls_background;
+static uint16_t controls_dirty_groups;
+static uint16_t controls_built_groups;      // rebuilt in controls_frame
+static uint16_t controls_frame;
 
 static void core1_func(void);
 static void render_scanline(scanvideo_scanline_buffer_t *buffer);
@@ -178,19 +353,34 @@ static void initialize_gpio(void);
 static void gpio_callback(uint gpio, uint32_t events);
 static void gpio_callback_VIDEO(uint gpio, uint32_t events);
 static bool button_is_pressed(controller_button_t button);
+static inline uint16_t pressed_buttons(void);
 static bool button_was_released(controller_button_t button);
 static void set_button(controller_button_t button, button_state_t state);
+static void build_controls_grid(void);
+static void reset_controls(void);
+static void build_controls_line(uint8_t group);
+static void build_controls_lines(void);
+static void update_controls_lines(void);
 static void __no_inline_not_in_flash_func(command_check)(void);
 static void update_osd(void);
+static void toggle_osd(void);
+static void update_perf_hud(bool restart);
+static void perf_hud_tasks(void);
+static void check_fingerprint(void);
+static void change_palette_region(uint8_t line, int direction);
 static void blink(uint8_t count, uint16_t millis_on, uint16_t millis_off);
 static void change_backlight_level(int direction);
-static void set_orientation(void);
-static bool rect_contains_point(const rectangle_t* rect, uint16_t x, uint16_t y);
-static void touchup(uint16_t x, uint16_t y);
-static void touchdown(uint16_t x, uint16_t y);
+static void set_orientation(orientation_t new_orientation);
+static void scale_touch_point(uint16_t* x, uint16_t* y);
+static uint16_t controls_buttons_at(uint16_t x, uint16_t y);
+static void set_buttons(uint16_t buttons, button_state_t state);
+static void set_touch_buttons(uint8_t id, uint16_t buttons);
+static void touchup(uint8_t id, uint16_t x, uint16_t y);
+static void touchdown(uint8_t id, uint16_t x, uint16_t y);
+static void touchmove(uint8_t id, uint16_t x, uint16_t y);
 
 int32_t single_solid_line(uint32_t *buf, size_t buf_length, uint16_t color);
-int32_t single_scanline(uint32_t *buf, size_t buf_length, uint8_t line_index);
+int32_t single_scanline(uint32_t *buf, size_t buf_length, uint8_t line_index, uint16_t frame, uint8_t sub_row, bool composite);
 
 int main(void) 
 {
@@ -200,6 +390,11 @@ int main(void)
     //set_sys_clock_khz(300000, true);
     set_sys_clock_khz(240000, true);
 
+    TRACE_init();
+    TELEMETRY_init();
+    LAYOUT_init();
+    set_orientation(DEFAULT_ORIENTATION);
+
     // Create a semaphore to be posted when video init is complete.
     sem_init(&video_initted, 0, 1);
 
@@ -209,6 +404,9 @@ int main(void)
     // Wait for initialization of video to be complete.
     sem_acquire_blocking(&video_initted);
 
+    // after scanvideo_setup has claimed its fixed DMA channel
+    ARTWORK_init();
+
     initialize_gpio();
 
     // prevent false trigger of OSD on start -- set all previous button states to 1 (unpressed)
@@ -221,17 +419,26 @@ int main(void)
     set_background_color(COLOR_LIGHT_GREY);
     background_color = rgb888_to_rgb222(get_background_color());
 
-    color_scheme = get_scheme();
+    build_scheme_luts();
+    SETTINGS_init();
+    SETTINGS_apply(game_id);
+    FINGERPRINT_init();
     control_scheme = get_control_scheme();
     
     osd_framebuffer = OSD_get_framebuffer();
     update_osd();
 
-    set_orientation();
+    build_controls_grid();
+    build_controls_lines();
 
-    TOUCH_init(i2cHandle);
+    TOUCH_init(i2cHandle, TOUCH_INT_PIN);
     TOUCH_set_touchup_callback(&touchup);
     TOUCH_set_touchdown_callback(&touchdown);
+    TOUCH_set_touchmove_callback(&touchmove);
+
+    // SysTick on the capture core as a free running cycle counter
+    systick_hw->rvr = SYSTICK_MASK;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
 
     gpio_set_irq_enabled_with_callback(VSYNC_PIN, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, &gpio_callback_VIDEO);
 
@@ -243,104 +450,125 @@ int main(void)
             command_check();
         }
         #endif
+
+        check_fingerprint();
+        update_controls_lines();
+        perf_hud_tasks();
+        LATENCY_tasks();
+        TELEMETRY_tasks();
         
         //blink(3, 100, 2000);
     }
 }
 
-int32_t single_scanline(uint32_t *buf, size_t buf_length, uint8_t line_index)
+// Game pixels from x_start to x_end, switching LUTs at palette region
+// boundaries.  Dither phase alternates between even and odd pixels.
+static inline uint16_t* game_segments(uint16_t* p16, const uint8_t* pixels, uint16_t x_start, uint16_t x_end, uint8_t line_index, uint16_t frame, uint8_t sub_row)
+{
+    const palette_segments_t* segments = get_palette_segments(line_index);
+    const palette_segment_t* segment = segments->segments;
+    const palette_segment_t* segments_end = segment + segments->count;
+
+    for (; segment < segments_end; segment++)
+    {
+        uint16_t start = segment->start > x_start ? segment->start : x_start;
+        uint16_t end = segment->end < x_end ? segment->end : x_end;
+        if (start >= end)
+            continue;
+
+#ifdef DOT_MATRIX_MODE
+        const dot_template_t* luts[2] = 
+        {
+            get_dot_matrix_templates(segment->region, FRC_PHASE(0, line_index, frame), sub_row),
+            get_dot_matrix_templates(segment->region, FRC_PHASE(1, line_index, frame), sub_row)
+        };
+#else
+        const uint16_t* luts[2] = 
+        {
+            get_region_lut(segment->region, FRC_PHASE(0, line_index, frame)),
+            get_region_lut(segment->region, FRC_PHASE(1, line_index, frame))
+        };
+#endif
+        p16 = GAME_SPAN(p16, pixels + start, start, end - start, luts);
+    }
+    return p16;
+}
+
+// OSD pixels for one output line.  The OSD framebuffer is already in
+// output order (see OSD_set_orientation).
+static inline uint16_t* osd_span(uint16_t* p16, uint8_t line_index, uint16_t x_start, uint16_t x_end)
+{
+    const uint8_t* posd = &osd_framebuffer[(x_start - rect_osd.x) + ((line_index - rect_osd.y) * rect_osd.width)];
+
+    for (uint16_t x = x_start; x < x_end; x++)
+    {
+        for (int i = 0; i < DMG_PIXEL_TOKENS; i++)
+        {
+            *p16++ = *posd;
+        }
+        posd++;
+    }
+    return p16;
+}
+
+static inline bool controls_on_line(uint8_t line_index)
+{
+    return (line_index / CONTROLS_SCALE) < CONTROLS_LINE_GROUPS;
+}
+
+static inline bool osd_on_line(uint8_t line_index)
+{
+    return OSD_is_enabled() 
+        && osd_framebuffer != NULL
+        && (line_index >= rect_osd.y)
+        && (line_index < (rect_osd.y+rect_osd.height));
+}
+
+int32_t __not_in_flash_func(single_scanline)(uint32_t *buf, size_t buf_length, uint8_t line_index, uint16_t frame, uint8_t sub_row, bool composite)
 {
     uint16_t* p16 = (uint16_t *) buf;
     uint16_t* first_pixel;
     uint16_t pixel_count = 0;
 
     // GAME WINDOW
+    // Pixels are written contiguously starting at the count slot, then the
+    // first pixel is moved into place and the count written over it.
     *p16++ = COMPOSABLE_RAW_RUN;
-    first_pixel = p16;
-    *p16++ = 0; // replaced later - first pixel
-    *p16++ = rect_gamewindow.width - MIN_RUN;
-    
-    uint8_t *pbuff = &framebuffer[line_index * rect_gamewindow.width];
+    first_pixel = p16++;
 
-    uint16_t pos = 0;
-    uint16_t x;
-    uint16_t i = 0;
-    uint16_t color = 0;
+    uint8_t *pbuff = &framebuffer[line_index * rect_gamewindow.width];
 
-    uint16_t idx;
-    uint16_t rot_x;
-    uint16_t rot_y;
-    for (x = 0; x < rect_gamewindow.width; x++)
+    uint16_t osd_start = rect_gamewindow.width;
+    uint16_t osd_end = rect_gamewindow.width;
+    if (composite && osd_on_line(line_index))
     {
-        if (x == 0 && i == 0)
-        {
-            *first_pixel = rgb888_to_rgb222( *((uint32_t*)color_scheme + *pbuff) ) ;
-        }
-        else
-        {
-            if ( OSD_is_enabled() 
-                && (line_index >= rect_osd.y)
-                && (line_index <= (rect_osd.y+rect_osd.height))
-                && (x >= rect_osd.x)
-                && (x <= (rect_osd.x+rect_osd.width)))
-            {
-                // ROTATE 270
-                rot_x = rect_osd.height - 1 - (line_index-rect_osd.y);
-                rot_y = x - rect_osd.x;
-               
-                idx = rot_x + (rot_y * OSD_WIDTH);
-                if (osd_framebuffer != NULL && idx < (OSD_WIDTH*OSD_HEIGHT))
-                    color = (uint16_t)(osd_framebuffer[idx]);
-            }
-            else
-            {
-                color = rgb888_to_rgb222( *((uint32_t*)color_scheme + *pbuff) ) ;
-            }
-
-            *p16++ = color; 
-        }
+        osd_start = rect_osd.x;
+        osd_end = rect_osd.x + rect_osd.width;
+    }
 
-        pbuff++;
-        pixel_count++;
+    p16 = game_segments(p16, pbuff, 0, osd_start, line_index, frame, sub_row);
+    if (osd_start < osd_end)
+    {
+        p16 = osd_span(p16, line_index, osd_start, osd_end);
+        p16 = game_segments(p16, pbuff, osd_end, rect_gamewindow.width, line_index, frame, sub_row);
     }
+
+    pixel_count = rect_gamewindow.width * DMG_PIXEL_TOKENS;
+    *first_pixel = first_pixel[1];
+    first_pixel[1] = pixel_count - MIN_RUN;
     
-    uint16_t remaining = (VGA_MODE.width/VGA_MODE.xscale) - rect_gamewindow.width;
-    if (remaining > MIN_RUN)
+    // CONTROLS PANEL
+    uint8_t group = line_index / CONTROLS_SCALE;
+    if (controls_on_line(line_index))
     {
-        *p16++ = COMPOSABLE_RAW_RUN;
-        *p16++ = rgb888_to_rgb222(control_scheme->background_color);  // TODO: use control scheme backcolor instead
-        pixel_count++;
-        *p16++ = remaining - MIN_RUN;
-        
-        uint16_t clr = 0;
-        uint16_t left_pixels = remaining;
-        uint16_t y = line_index;
-
-        // alternative using uint16 binary-literal array
-        uint8_t rot_xxx;
-        uint8_t rot_yyy;
-        uint8_t xxx10;
-        uint8_t yyy10 = line_index / 10;
-        uint8_t posss;
-        for (uint16_t x = 1; x < left_pixels; x++)   // start at 1... already did a pixel
-        {
-            
-            xxx10 = x / 10;
-             rot_xxx = 16 - 1 - yyy10;      // 270
-             rot_yyy = xxx10;               // 270
-            if (rot_yyy < 12 )
-            {
-                posss = rot_xxx + (rot_yyy * 16);
-                clr = rgb888_to_rgb222( *((uint32_t*)control_scheme + framebuffer_controls_8bit[posss]) );
-            }
-            else
-            {
-                clr = rgb888_to_rgb222(control_scheme->background_color);
-            }
-            
-            *p16++ = clr;
-            pixel_count++;
-        }
+        const controls_line_t* controls = controls_lines[group];
+        uint16_t width = (VGA_MODE.width/VGA_MODE.xscale)/DMG_PIXEL_TOKENS - rect_gamewindow.width;
+        uint16_t background = get_ambient_enabled() ? ambient_tokens[line_index] : controls_background;
+        if (composite)
+            p16 = ARTWORK_render_line(p16, line_index, width, DMG_PIXEL_TOKENS, background, controls->spans, controls->span_count);
+        else
+            p16 = ARTWORK_run(p16, background, width * DMG_PIXEL_TOKENS);
+        pixel_count += width * DMG_PIXEL_TOKENS;
     }
    
     if (pixel_count*VGA_MODE.xscale < VGA_MODE.width)
@@ -366,12 +594,21 @@ int32_t single_scanline(uint32_t *buf, size_t buf_length, uint8_t line_index)
     *p16++ = COMPOSABLE_RAW_1P;
     *p16++ = 0;
 
-    *p16++ = COMPOSABLE_EOL_ALIGN;  // TODO... how to determine when to do skip align
+    // artwork runs vary in length, so pad the EOL to a word boundary as needed
+    if (2 & (uintptr_t) p16)
+    {
+        *p16++ = COMPOSABLE_EOL_ALIGN;
+    }
+    else
+    {
+        *p16++ = COMPOSABLE_EOL_SKIP_ALIGN;
+        *p16++ = 0;
+    }
 
     return ((uint32_t *) p16) - buf;
 }
 
-int32_t single_solid_line(uint32_t *buf, size_t buf_length, uint16_t color)
+int32_t __not_in_flash_func(single_solid_line)(uint32_t *buf, size_t buf_length, uint16_t color)
 {
     uint16_t *p16 = (uint16_t *) buf;
 
@@ -388,24 +625,105 @@ int32_t single_solid_line(uint32_t *buf, size_t buf_length, uint16_t color)
     return ((uint32_t *) p16) - buf;
 }
 
-static void render_scanline(scanvideo_scanline_buffer_t *dest) 
+// Lines between the one scanvideo sends next and this one -- zero or less
+// means this line is already due
+static inline int scanline_lead(uint32_t scanline_id)
 {
+    uint32_t shown_id = scanvideo_get_next_scanline_id();
+    int16_t frames_ahead = (int16_t)(scanvideo_frame_number(scanline_id) - scanvideo_frame_number(shown_id));
+    return scanvideo_scanline_number(scanline_id) - scanvideo_scanline_number(shown_id) + (frames_ahead * SCANLINES_PER_FRAME);
+}
+
+// Once per panel frame, counts the DMG frames captured since the last one.
+// None means the panel shows the same frame again; more than one means
+// frames were never shown.
+static inline void pace_output_frame(uint16_t frame)
+{
+    static uint16_t last_frame;
+    static uint32_t last_captured;
+    if (frame == last_frame)
+        return;
+
+    uint32_t captured = capture_stats.frames;
+    uint32_t new_frames = captured - last_captured;
+    last_frame = frame;
+    last_captured = captured;
+
+    render_health.output_frames++;
+    if (new_frames == 0)
+        render_health.repeated_frames++;
+    else
+        render_health.dropped_frames += new_frames - 1;
+}
+
+// Picks the render level from how far ahead of the beam this scanline is.
+// Once a frame falls behind it stays degraded to its end, so the picture
+// does not flicker between levels; a line that is already due gets a solid
+// line, which is the cheapest thing scanvideo can still send on time.
+static inline render_level_t render_level(uint32_t scanline_id)
+{
+    static uint32_t degraded_frame = UINT32_MAX;
+    uint16_t frame = scanvideo_frame_number(scanline_id);
+    int lead = scanline_lead(scanline_id);
+
+    if (lead <= 0)
+    {
+        render_health.solid_lines++;
+        TRACE_INSTANT(RENDER_DEGRADED, RENDER_SOLID);
+        return RENDER_SOLID;
+    }
+
+    if (lead < RENDER_LEAD_MIN && frame != degraded_frame)
+    {
+        degraded_frame = frame;
+        render_health.degraded_frames++;
+        TRACE_INSTANT(RENDER_DEGRADED, RENDER_GAME_ONLY);
+    }
+
+    if (frame == degraded_frame)
+    {
+        render_health.degraded_lines++;
+        return RENDER_GAME_ONLY;
+    }
+    return RENDER_FULL;
+}
+
+static void __not_in_flash_func(render_scanline)(scanvideo_scanline_buffer_t *dest) 
+{
+    uint32_t start = RENDER_STATS_now();
+    render_line_type_t type = RENDER_LINE_SOLID;
     uint32_t *buf = dest->data;
     size_t buf_length = dest->data_max;
-    int line_num = scanvideo_scanline_number(dest->scanline_id);
+    int scanline = scanvideo_scanline_number(dest->scanline_id);
+    int line_num = scanline / DMG_PIXEL_TOKENS;
+    uint8_t sub_row = scanline % DMG_PIXEL_TOKENS;
+    uint16_t frame = scanvideo_frame_number(dest->scanline_id);
     int line_start = rect_gamewindow.y;
     int line_end = rect_gamewindow.y + rect_gamewindow.height;
+    render_level_t level = render_level(dest->scanline_id);
+
+    pace_output_frame(frame);
     
-    if (line_num < line_start || line_num > line_end)
+    if (line_num < line_start || line_num >= line_end || level == RENDER_SOLID)
     {
         dest->data_used = single_solid_line(buf, buf_length, background_color);
     }
     else
     {
-        dest->data_used = single_scanline(buf, buf_length, (uint8_t)(line_num - rect_gamewindow.y));
+        uint8_t line_index = (uint8_t)(line_num - rect_gamewindow.y);
+        bool composite = (level == RENDER_FULL);
+        dest->data_used = single_scanline(buf, buf_length, line_index, frame, sub_row, composite);
+        LATENCY_render_line(line_index);
+        if (composite && osd_on_line(line_index))
+            type = RENDER_LINE_GAME_OSD;
+        else if (composite && controls_on_line(line_index))
+            type = RENDER_LINE_GAME_CONTROLS;
+        else
+            type = RENDER_LINE_GAME;
     }
 
     dest->status = SCANLINE_OK;
+    RENDER_STATS_record(type, start, scanline_lead(dest->scanline_id) <= 0);
 }
 
 static void core1_func(void) 
@@ -413,6 +731,12 @@ static void core1_func(void)
     
     hard_assert(VGA_MODE.width + 4 <= PICO_SCANVIDEO_MAX_SCANLINE_BUFFER_WORDS * 2);    
 
+    // settings writes pause this core while flash is erased
+    multicore_lockout_victim_init();
+
+    init_render_interp();
+    RENDER_STATS_init();
+
     // Initialize video and interrupts on core 1.
     scanvideo_setup(&VGA_MODE);
     scanvideo_timing_enable(true);
@@ -423,8 +747,13 @@ static void core1_func(void)
 
     while (true) 
     {
+        TRACE_BEGIN(SCANLINE_WAIT, 0);
         scanvideo_scanline_buffer_t *scanline_buffer = scanvideo_begin_scanline_generation(true);
+        TRACE_END(SCANLINE_WAIT, 0);
+
+        TRACE_BEGIN(SCANLINE, scanvideo_scanline_number(scanline_buffer->scanline_id));
         render_scanline(scanline_buffer);
+        TRACE_END(SCANLINE, 0);
         scanvideo_end_scanline_generation(scanline_buffer);
     }
 }
@@ -488,8 +817,10 @@ static void initialize_gpio(void)
 
 }
 
-static void gpio_callback(uint gpio, uint32_t events) 
+static void __not_in_flash_func(gpio_callback)(uint gpio, uint32_t events) 
 {
+    TRACE_INSTANT(JOYPAD, gpio);
+
     // Prevent controller input to game if OSD is visible
     if (OSD_is_enabled())
         return;
@@ -502,6 +833,7 @@ static void gpio_callback(uint gpio, uint32_t events)
             gpio_put(DMG_OUTPUT_LEFT_B_PIN, button_states[BUTTON_LEFT]);
             gpio_put(DMG_OUTPUT_UP_SELECT_PIN, button_states[BUTTON_UP]);
             gpio_put(DMG_OUTPUT_DOWN_START_PIN, button_states[BUTTON_DOWN]);
+            LATENCY_game_read((1 << BUTTON_RIGHT) | (1 << BUTTON_LEFT) | (1 << BUTTON_UP) | (1 << BUTTON_DOWN));
         }
 
         //TODO: it might be best to read BUTTONS when this goes high
@@ -515,6 +847,7 @@ static void gpio_callback(uint gpio, uint32_t events)
             gpio_put(DMG_OUTPUT_LEFT_B_PIN, button_states[BUTTON_B]);
             gpio_put(DMG_OUTPUT_UP_SELECT_PIN, button_states[BUTTON_SELECT]);
             gpio_put(DMG_OUTPUT_DOWN_START_PIN, button_states[BUTTON_START]);
+            LATENCY_game_read((1 << BUTTON_A) | (1 << BUTTON_B) | (1 << BUTTON_SELECT) | (1 << BUTTON_START));
 
             // Prevent in-game reset lockup
             // If A,B,Select and Start are all pressed, release them!
@@ -543,6 +876,15 @@ static bool button_is_pressed(controller_button_t button)
     return button_states[button] == BUTTON_STATE_PRESSED;
 }
 
+// Bit per controller_button_t.  Inlined so the joypad interrupt stays in RAM.
+static inline __attribute__((always_inline)) uint16_t pressed_buttons(void)
+{
+    uint16_t pressed = 0;
+    for (int i = 0; i < BUTTON_COUNT; i++)
+        pressed |= (button_states[i] == BUTTON_STATE_PRESSED) ? (1 << i) : 0;
+    return pressed;
+}
+
 static bool button_was_released(controller_button_t button)
 {
     return button_states[button] == BUTTON_STATE_UNPRESSED && button_states_previous[button] == BUTTON_STATE_PRESSED;
@@ -551,62 +893,151 @@ static bool button_was_released(controller_button_t button)
 static void set_button(controller_button_t button, button_state_t state)
 {
     button_states[button] = state;
-    if (button == BUTTON_A)
-    {
-        framebuffer_controls_8bit[16*4 + 13] = state == BUTTON_STATE_PRESSED ? 3 : 2;
-        framebuffer_controls_8bit[16*4 + 14] = state == BUTTON_STATE_PRESSED ? 3 : 2;
-        framebuffer_controls_8bit[16*5 + 13] = state == BUTTON_STATE_PRESSED ? 3 : 2;
-        framebuffer_controls_8bit[16*5 + 14] = state == BUTTON_STATE_PRESSED ? 3 : 2;
-    }
-    else if (button == BUTTON_B)
-    {
-        framebuffer_controls_8bit[16*6 + 10] = state == BUTTON_STATE_PRESSED ? 3 : 2;
-        framebuffer_controls_8bit[16*6 + 11] = state == BUTTON_STATE_PRESSED ? 3 : 2;
-        framebuffer_controls_8bit[16*7 + 10] = state == BUTTON_STATE_PRESSED ? 3 : 2;
-        framebuffer_controls_8bit[16*7 + 11] = state == BUTTON_STATE_PRESSED ? 3 : 2;
-    }
-    else if (button == BUTTON_RIGHT)
-    {
-        framebuffer_controls_8bit[16*6 + 5] = state == BUTTON_STATE_PRESSED ? 3 : 1;
-        framebuffer_controls_8bit[16*6 + 6] = state == BUTTON_STATE_PRESSED ? 3 : 1;
-        framebuffer_controls_8bit[16*7 + 5] = state == BUTTON_STATE_PRESSED ? 3 : 1;
-        framebuffer_controls_8bit[16*7 + 6] = state == BUTTON_STATE_PRESSED ? 3 : 1;
-    }
-    else if (button == BUTTON_LEFT)
+    if (state == BUTTON_STATE_PRESSED && button != BUTTON_HOME)
+        LATENCY_input(1 << button, false);
+
+    controls_dirty_groups |= button_line_groups[button];
+}
+
+static void set_buttons(uint16_t buttons, button_state_t state)
+{
+    while (buttons)
     {
-        framebuffer_controls_8bit[16*6 + 1] = state == BUTTON_STATE_PRESSED ? 3 : 1;
-        framebuffer_controls_8bit[16*6 + 2] = state == BUTTON_STATE_PRESSED ? 3 : 1;
-        framebuffer_controls_8bit[16*7 + 1] = state == BUTTON_STATE_PRESSED ? 3 : 1;
-        framebuffer_controls_8bit[16*7 + 2] = state == BUTTON_STATE_PRESSED ? 3 : 1;
+        set_button(__builtin_ctz(buttons), state);
+        buttons &= buttons - 1;
     }
-    else if (button == BUTTON_UP)
+}
+
+// Whether a cell of an area is part of its shape
+static bool area_has_cell(const layout_area_t* area, uint8_t cell, uint8_t group)
+{
+    if (area->shape != LAYOUT_SHAPE_ROUND)
+        return true;
+
+    // cell centre inside the ellipse, in half cells from the area centre
+    int32_t dx = 2 * (cell - area->cell) + 1 - area->cells;
+    int32_t dy = 2 * (group - area->group) + 1 - area->groups;
+    return dx * dx * area->groups * area->groups + dy * dy * area->cells * area->cells
+        <= area->cells * area->cells * area->groups * area->groups;
+}
+
+// Rebuilds the grid from the current layout.  Release the touch buttons
+// first when the layout changes, as the grid no longer says what is held.
+static void build_controls_grid(void)
+{
+    const layout_t* layout = LAYOUT_get();
+
+    memset(controls_grid, 0, sizeof(controls_grid));
+    memset(controls_grid_color, LAYOUT_COLOR_NONE, sizeof(controls_grid_color));
+    memset(button_line_groups, 0, sizeof(button_line_groups));
+    touch_calibration = layout->calibration;
+
+    for (uint8_t i = 0; i < layout->area_count; i++)
     {
-        framebuffer_controls_8bit[16*4 + 3] = state == BUTTON_STATE_PRESSED ? 3 : 1;
-        framebuffer_controls_8bit[16*4 + 4] = state == BUTTON_STATE_PRESSED ? 3 : 1;
-        framebuffer_controls_8bit[16*5 + 3] = state == BUTTON_STATE_PRESSED ? 3 : 1;
-        framebuffer_controls_8bit[16*5 + 4] = state == BUTTON_STATE_PRESSED ? 3 : 1;
+        const layout_area_t* area = &layout->areas[i];
+        for (uint8_t group = area->group; group < area->group + area->groups && group < controls_groups; group++)
+        {
+            for (uint8_t cell = area->cell; cell < area->cell + area->cells && cell < controls_cells; cell++)
+            {
+                if (!area_has_cell(area, cell, group))
+                    continue;
+
+                controls_grid[group][cell] = area->buttons;
+                controls_grid_color[group][cell] = area->color;
+            }
+        }
     }
-    else if (button == BUTTON_DOWN)
+
+    for (uint8_t group = 0; group < CONTROLS_LINE_GROUPS; group++)
     {
-        framebuffer_controls_8bit[16*8 + 3] = state == BUTTON_STATE_PRESSED ? 3 : 1;
-        framebuffer_controls_8bit[16*8 + 4] = state == BUTTON_STATE_PRESSED ? 3 : 1;
-        framebuffer_controls_8bit[16*9 + 3] = state == BUTTON_STATE_PRESSED ? 3 : 1;
-        framebuffer_controls_8bit[16*9 + 4] = state == BUTTON_STATE_PRESSED ? 3 : 1;
+        for (uint8_t cell = 0; cell < CONTROLS_ROWS; cell++)
+        {
+            for (uint8_t button = 0; button < BUTTON_COUNT; button++)
+            {
+                if (controls_grid[group][cell] & BUTTON_BIT(button))
+                    button_line_groups[button] |= 1u << group;
+            }
+        }
     }
-    else if (button == BUTTON_SELECT)
+}
+
+// Puts the controls back in line with the current layout and panel, with
+// no touch buttons held
+static void reset_controls(void)
+{
+    for (uint8_t id = 0; id < MAX_TOUCH_POINTS; id++)
+        set_touch_buttons(id, 0);
+    build_controls_grid();
+    build_controls_lines();
+}
+
+static void build_controls_line(uint8_t group)
+{
+    controls_line_t* line = (controls_lines[group] == &controls_line_buffers[group][0]) ? &controls_line_buffers[group][1] : &controls_line_buffers[group][0];
+    artwork_span_t* span = line->spans;
+    uint16_t pressed = pressed_buttons();
+
+    // cells with no color are left to the artwork; first pixel is always
+    // background
+    for (uint8_t row = 0; row < CONTROLS_ROWS; row++)
     {
-        framebuffer_controls_8bit[1] = state == BUTTON_STATE_PRESSED ? 3 : 1;
-        framebuffer_controls_8bit[2] = state == BUTTON_STATE_PRESSED ? 3 : 1;
+        uint8_t cell_color = controls_grid_color[group][row];
+        if (cell_color == LAYOUT_COLOR_NONE)
+            continue;
+
+        uint32_t rgb;
+        if (controls_grid[group][row] & pressed)
+            rgb = control_scheme->button_pressed;
+        else if (cell_color == LAYOUT_COLOR_AB)
+            rgb = control_scheme->button_color_ab;
+        else
+            rgb = control_scheme->button_color_other;
+
+        uint16_t color = rgb888_to_rgb222(rgb);
+        uint8_t x = row == 0 ? 1 : row * CONTROLS_SCALE;
+        uint8_t end = (row + 1) * CONTROLS_SCALE;
+        if (span > line->spans && span[-1].color == color && span[-1].x + span[-1].length == x)
+        {
+            span[-1].length = end - span[-1].x;
+        }
+        else
+        {
+            span->x = x;
+            span->length = end - x;
+            span->color = color;
+            span++;
+        }
     }
-    else if (button == BUTTON_HOME)
+
+    line->span_count = span - line->spans;
+    controls_lines[group] = line;
+}
+
+static void build_controls_lines(void)
+{
+    controls_background = rgb888_to_rgb222(control_scheme->background_color);
+    controls_dirty_groups = (1u << CONTROLS_LINE_GROUPS) - 1;
+    update_controls_lines();
+}
+
+// Rebuilds the dirty groups not already rebuilt this output frame; the
+// rest wait for the next one
+static void update_controls_lines(void)
+{
+    uint16_t frame = scanvideo_frame_number(scanvideo_get_next_scanline_id());
+    if (frame != controls_frame)
     {
-        framebuffer_controls_8bit[7] = state == BUTTON_STATE_PRESSED ? 3 : 1;
-        framebuffer_controls_8bit[8] = state == BUTTON_STATE_PRESSED ? 3 : 1;
+        controls_frame = frame;
+        controls_built_groups = 0;
     }
-    else if (button == BUTTON_START)
+
+    uint16_t groups = controls_dirty_groups & ~controls_built_groups;
+    controls_dirty_groups &= ~groups;
+    controls_built_groups |= groups;
+    while (groups)
     {
-        framebuffer_controls_8bit[13] = state == BUTTON_STATE_PRESSED ? 3 : 1;
-        framebuffer_controls_8bit[14] = state == BUTTON_STATE_PRESSED ? 3 : 1;
+        build_controls_line(__builtin_ctz(groups));
+        groups &= groups - 1;
     }
 }
 
@@ -615,14 +1046,28 @@ static void __no_inline_not_in_flash_func(command_check)(void)
     if (memcmp(button_states, button_states_previous, sizeof(button_states)) == 0)
         return;
 
+    TRACE_BEGIN(COMMAND_CHECK, 0);
+
+    TELEMETRY_send_buttons(pressed_buttons());
+
     // Home pressed
     if (button_was_released(BUTTON_HOME))
     {
-        OSD_toggle();
+        toggle_osd();
     }
     else
     {
-        if (OSD_is_enabled())
+        if (OSD_is_enabled() && OSD_get_page() == OSD_PAGE_PERF)
+        {
+            // the only line to act on is BACK
+            if (button_was_released(BUTTON_RIGHT) 
+                || button_was_released(BUTTON_LEFT)
+                || button_was_released(BUTTON_A))
+            {
+                OSD_set_page(OSD_PAGE_SETTINGS);
+            }
+        }
+        else if (OSD_is_enabled())
         {
             if (button_was_released(BUTTON_DOWN))
             {
@@ -641,13 +1086,68 @@ static void __no_inline_not_in_flash_func(command_check)(void)
                 if (line == OSD_LINE_COLOR_SCHEME)
                 {
                     change_color_scheme_index(leftbtn ? -1 : 1);
-                    color_scheme = get_scheme();
+                    settings_dirty = true;
+                    update_osd();
+                }
+                else if (line == OSD_LINE_REGION)
+                {
+                    edit_region += leftbtn ? -1 : 1;
+                    edit_region = edit_region >= PALETTE_REGIONS ? 1 : edit_region;
+                    edit_region = edit_region < 1 ? (PALETTE_REGIONS-1) : edit_region;
+                    update_osd();
+                }
+                else if (line == OSD_LINE_REGION_SCHEME 
+                        || line == OSD_LINE_REGION_FIRST
+                        || line == OSD_LINE_REGION_LAST)
+                {
+                    change_palette_region(line, leftbtn ? -1 : 1);
+                    settings_dirty = true;
                     update_osd();
                 }
                 else if (line == OSD_LINE_BACK_COLOR)
                 {
                     change_control_scheme_index(leftbtn ? -1 : 1);
                     control_scheme = get_control_scheme();
+                    build_controls_lines();
+                    update_osd();
+                }
+                else if (line == OSD_LINE_DITHER)
+                {
+                    set_dither_enabled(!get_dither_enabled());
+                    update_osd();
+                }
+                else if (line == OSD_LINE_BLEND)
+                {
+                    change_blend_level(leftbtn ? -1 : 1);
+                    update_osd();
+                }
+#ifdef DOT_MATRIX_MODE
+                else if (line == OSD_LINE_DOT_GRID)
+                {
+                    set_dot_grid_enabled(!get_dot_grid_enabled());
+                    update_osd();
+                }
+#endif
+                else if (line == OSD_LINE_SKIN)
+                {
+                    ARTWORK_change(leftbtn ? -1 : 1);
+                    update_osd();
+                }
+                else if (line == OSD_LINE_LAYOUT)
+                {
+                    LAYOUT_change(leftbtn ? -1 : 1);
+                    reset_controls();
+                    update_osd();
+                }
+                else if (line == OSD_LINE_AMBIENT)
+                {
+                    set_ambient_enabled(!get_ambient_enabled());
+                    update_osd();
+                }
+                else if (line == OSD_LINE_ORIENTATION)
+                {
+                    set_orientation((orientation + (leftbtn ? ORIENTATION_COUNT - 1 : 1)) % ORIENTATION_COUNT);
+                    reset_controls();
                     update_osd();
                 }
                 else if (line == OSD_LINE_BACKLIGHT)
@@ -655,9 +1155,15 @@ static void __no_inline_not_in_flash_func(command_check)(void)
                     change_backlight_level(leftbtn ? -1 : 1);
                     update_osd();
                 }
+                else if (line == OSD_LINE_PERF_HUD)
+                {
+                    update_perf_hud(true);
+                    OSD_set_page(OSD_PAGE_PERF);
+                    OSD_set_active_line(HUD_LINE_BACK);
+                }
                 else
                 {
-                    OSD_toggle();
+                    toggle_osd();
                 }
             }
         }
@@ -668,25 +1174,283 @@ static void __no_inline_not_in_flash_func(command_check)(void)
         button_states_previous[i] = button_states[i];
     }
     //OR... memcpy(button_states_previous, button_states, BUTTON_COUNT);
+
+    TRACE_END(COMMAND_CHECK, 0);
 }
 
 static void update_osd(void)
 {
     char buff[32];
     sprintf(buff, "COLOR SCHEME:% 5d", get_scheme_index());
-    OSD_set_line_text(OSD_LINE_COLOR_SCHEME, buff);
+    OSD_set_line_text(OSD_PAGE_SETTINGS, OSD_LINE_COLOR_SCHEME, buff);
+
+    const palette_region_t* region = get_palette_region(edit_region);
+    sprintf(buff, "PALETTE REGION:% 3d", edit_region);
+    OSD_set_line_text(OSD_PAGE_SETTINGS, OSD_LINE_REGION, buff);
+
+    if (region->scheme == PALETTE_REGION_OFF)
+        sprintf(buff, "  SCHEME:%9s", "OFF");
+    else
+        sprintf(buff, "  SCHEME:% 9d", region->scheme);
+    OSD_set_line_text(OSD_PAGE_SETTINGS, OSD_LINE_REGION_SCHEME, buff);
+
+    sprintf(buff, "  FIRST LINE:% 5d", region->first_line);
+    OSD_set_line_text(OSD_PAGE_SETTINGS, OSD_LINE_REGION_FIRST, buff);
+
+    sprintf(buff, "  LAST LINE:% 6d", region->last_line);
+    OSD_set_line_text(OSD_PAGE_SETTINGS, OSD_LINE_REGION_LAST, buff);
 
     sprintf(buff, "BACK COLOR:% 7d", get_control_scheme_index());
-    OSD_set_line_text(OSD_LINE_BACK_COLOR, buff);
+    OSD_set_line_text(OSD_PAGE_SETTINGS, OSD_LINE_BACK_COLOR, buff);
+
+    sprintf(buff, "DITHER:%11s", get_dither_enabled() ? "ON" : "OFF");
+    OSD_set_line_text(OSD_PAGE_SETTINGS, OSD_LINE_DITHER, buff);
+
+    sprintf(buff, "FRAME BLEND:% 6d", get_blend_percent());
+    OSD_set_line_text(OSD_PAGE_SETTINGS, OSD_LINE_BLEND, buff);
+
+#ifdef DOT_MATRIX_MODE
+    sprintf(buff, "DOT GRID:%9s", get_dot_grid_enabled() ? "ON" : "OFF");
+    OSD_set_line_text(OSD_PAGE_SETTINGS, OSD_LINE_DOT_GRID, buff);
+#endif
+
+    sprintf(buff, "SKIN:%13s", ARTWORK_get_name());
+    OSD_set_line_text(OSD_PAGE_SETTINGS, OSD_LINE_SKIN, buff);
+
+    sprintf(buff, "LAYOUT:%11s", LAYOUT_get_name());
+    OSD_set_line_text(OSD_PAGE_SETTINGS, OSD_LINE_LAYOUT, buff);
+
+    sprintf(buff, "AMBIENT:%10s", get_ambient_enabled() ? "ON" : "OFF");
+    OSD_set_line_text(OSD_PAGE_SETTINGS, OSD_LINE_AMBIENT, buff);
+
+    sprintf(buff, "ROTATE:%11s", orientation_labels[orientation]);
+    OSD_set_line_text(OSD_PAGE_SETTINGS, OSD_LINE_ORIENTATION, buff);
 
     sprintf(buff, "BACKLIGHT:% 8d", backlight_level);
-    OSD_set_line_text(OSD_LINE_BACKLIGHT, buff);
+    OSD_set_line_text(OSD_PAGE_SETTINGS, OSD_LINE_BACKLIGHT, buff);
 
-    OSD_set_line_text(OSD_LINE_EXIT, "EXIT");
+    OSD_set_line_text(OSD_PAGE_SETTINGS, OSD_LINE_PERF_HUD, "PERFORMANCE");
+    OSD_set_line_text(OSD_PAGE_SETTINGS, OSD_LINE_EXIT, "EXIT");
 
     OSD_update();
 }
 
+// Closing the menu writes any changed palette settings for the current game
+static void toggle_osd(void)
+{
+    OSD_toggle();
+    if (!OSD_is_enabled() && settings_dirty)
+    {
+        SETTINGS_save(game_id);
+        settings_dirty = false;
+    }
+
+    if (OSD_is_enabled() && OSD_get_page() == OSD_PAGE_PERF)
+        update_perf_hud(true);
+}
+
+static perf_snapshot_t take_perf_snapshot(void)
+{
+    capture_stats_t capture;
+    CAPTURE_STATS_read(&capture);
+
+    perf_snapshot_t snapshot =
+    {
+        .time_us = time_us_32(),
+        .output_frames = render_health.output_frames,
+        .dropped_frames = render_health.dropped_frames,
+        .repeated_frames = render_health.repeated_frames,
+        .capture_errors = capture.frames_aborted + capture.short_lines,
+        .capture_busy_us = capture_busy_us,
+        .render_busy_cycles = RENDER_STATS_get_busy_cycles(),
+    };
+    return snapshot;
+}
+
+// Percent of a scanline's time left over by the p99 render of a line type,
+// or blank if no line of the type has been rendered since the page opened
+static void format_headroom(char* buff, const char* label, render_line_type_t type)
+{
+    render_stats_summary_t summary;
+    RENDER_STATS_get(type, &summary);
+    if (summary.lines == 0)
+    {
+        sprintf(buff, "%s", label);
+        return;
+    }
+
+    // cycles for a scanline buffer, which covers yscale panel lines
+    const scanvideo_timing_t* timing = VGA_MODE.default_timing;
+    uint32_t budget = (uint32_t)(((uint64_t)clock_get_hz(clk_sys) * timing->h_total * VGA_MODE.yscale) / timing->clock_freq);
+    int headroom = (int)(((int64_t)budget - summary.p99) * 100 / budget);
+    headroom = headroom < 0 ? 0 : headroom;     // over budget shows in MISSED LINES
+    sprintf(buff, "%s%*d%%", label, (int)(OSD_CHARS_PER_LINE - 1 - strlen(label)), headroom);
+}
+
+// Performance page.  Refreshed for each captured frame while it is shown;
+// frame rates, drops and core loads are over the last PERF_WINDOW_US, the
+// rest since the page was opened.  It runs in the core0 main loop, which
+// the capture interrupt preempts, and only lines whose text changed are
+// redrawn, so keeping the page up barely moves its own numbers.
+static void update_perf_hud(bool restart)
+{
+    static perf_snapshot_t opened;
+    static perf_snapshot_t window;
+    static uint32_t out_fps_x10, dropped, repeated, core0_percent, core1_percent;
+    perf_snapshot_t now = take_perf_snapshot();
+    char buff[32];
+
+    if (restart)
+    {
+        RENDER_STATS_reset();
+        opened = now;
+        window = now;
+        out_fps_x10 = dropped = repeated = core0_percent = core1_percent = 0;
+    }
+    else if (now.time_us - window.time_us >= PERF_WINDOW_US)
+    {
+        uint32_t elapsed_us = now.time_us - window.time_us;
+        uint32_t cycles_per_us = clock_get_hz(clk_sys) / 1000000;
+        out_fps_x10 = (uint32_t)(((uint64_t)(now.output_frames - window.output_frames) * 10000000) / elapsed_us);
+        dropped = now.dropped_frames - window.dropped_frames;
+        repeated = now.repeated_frames - window.repeated_frames;
+        core0_percent = (uint32_t)(((uint64_t)(now.capture_busy_us - window.capture_busy_us) * 100) / elapsed_us);
+        core1_percent = (uint32_t)(((uint64_t)(now.render_busy_cycles - window.render_busy_cycles) * 100) / ((uint64_t)elapsed_us * cycles_per_us));
+        window = now;
+    }
+
+    capture_stats_t capture;
+    CAPTURE_STATS_read(&capture);
+    uint32_t in_fps_x10 = capture.frame_us ? 10000000 / capture.frame_us : 0;
+
+    sprintf(buff, "IN FPS:%9d.%d", (int)(in_fps_x10 / 10), (int)(in_fps_x10 % 10));
+    OSD_set_line_text(OSD_PAGE_PERF, HUD_LINE_IN_FPS, buff);
+
+    sprintf(buff, "OUT FPS:%8d.%d", (int)(out_fps_x10 / 10), (int)(out_fps_x10 % 10));
+    OSD_set_line_text(OSD_PAGE_PERF, HUD_LINE_OUT_FPS, buff);
+
+    sprintf(buff, "DROPPED:% 10d", (int)dropped);
+    OSD_set_line_text(OSD_PAGE_PERF, HUD_LINE_DROPPED, buff);
+
+    sprintf(buff, "REPEATED:% 9d", (int)repeated);
+    OSD_set_line_text(OSD_PAGE_PERF, HUD_LINE_REPEATED, buff);
+
+    uint32_t jitter = capture.line_cycles_max >= capture.line_cycles_min ? capture.line_cycles_max - capture.line_cycles_min : 0;
+    sprintf(buff, "JITTER CYC:% 7d", (int)jitter);
+    OSD_set_line_text(OSD_PAGE_PERF, HUD_LINE_JITTER, buff);
+
+    sprintf(buff, "CAPTURE ERR:% 6d", (int)(now.capture_errors - opened.capture_errors));
+    OSD_set_line_text(OSD_PAGE_PERF, HUD_LINE_CAPTURE_ERRORS, buff);
+
+    format_headroom(buff, "HEADROOM GAME:", RENDER_LINE_GAME);
+    OSD_set_line_text(OSD_PAGE_PERF, HUD_LINE_HEADROOM_GAME, buff);
+
+    format_headroom(buff, "HEADROOM OSD:", RENDER_LINE_GAME_OSD);
+    OSD_set_line_text(OSD_PAGE_PERF, HUD_LINE_HEADROOM_OSD, buff);
+
+    format_headroom(buff, "HEADROOM CTRL:", RENDER_LINE_GAME_CONTROLS);
+    OSD_set_line_text(OSD_PAGE_PERF, HUD_LINE_HEADROOM_CONTROLS, buff);
+
+    uint32_t missed = 0;
+    for (int type = 0; type < RENDER_LINE_TYPES; type++)
+    {
+        render_stats_summary_t summary;
+        RENDER_STATS_get(type, &summary);
+        missed += summary.missed;
+    }
+    sprintf(buff, "MISSED LINES:% 5d", (int)missed);
+    OSD_set_line_text(OSD_PAGE_PERF, HUD_LINE_MISSED, buff);
+
+    sprintf(buff, "CORE0:% 11d%%", (int)core0_percent);
+    OSD_set_line_text(OSD_PAGE_PERF, HUD_LINE_CORE0, buff);
+
+    sprintf(buff, "CORE1:% 11d%%", (int)core1_percent);
+    OSD_set_line_text(OSD_PAGE_PERF, HUD_LINE_CORE1, buff);
+
+    OSD_set_line_text(OSD_PAGE_PERF, HUD_LINE_BACK, "BACK");
+
+    OSD_update();
+}
+
+// Refreshes the performance page when a frame has been captured, or every
+// PERF_HUD_IDLE_US when the Game Boy is off
+static void perf_hud_tasks(void)
+{
+    static uint32_t last_frames;
+    static uint32_t last_update_us;
+
+    if (!OSD_is_enabled() || OSD_get_page() != OSD_PAGE_PERF)
+        return;
+
+    uint32_t frames = capture_stats.frames + capture_stats.frames_aborted;
+    uint32_t now_us = time_us_32();
+    if (frames == last_frames && (now_us - last_update_us) < PERF_HUD_IDLE_US)
+        return;
+
+    last_frames = frames;
+    last_update_us = now_us;
+    update_perf_hud(false);
+}
+
+// Stable screens seen after power on identify the game.  A profile the user
+// saved for the screen wins over the built in table; otherwise the latest
+// screen becomes the id that settings are saved under.
+static void check_fingerprint(void)
+{
+    uint32_t fingerprint;
+    if (!FINGERPRINT_poll(&fingerprint) || OSD_is_enabled())
+        return;
+
+    // every game shows the boot logo; keep looking for its title
+    int scheme = FINGERPRINT_lookup(fingerprint);
+    TELEMETRY_send_fingerprint(fingerprint, scheme);
+    if (scheme == FINGERPRINT_SKIP)
+        return;
+
+    if (SETTINGS_has_profile(fingerprint))
+    {
+        game_id = fingerprint;
+        SETTINGS_apply(game_id);
+        FINGERPRINT_stop();
+        update_osd();
+        return;
+    }
+
+    game_id = fingerprint;
+    if (scheme != FINGERPRINT_UNKNOWN)
+    {
+        set_color_scheme_index(scheme);
+        FINGERPRINT_stop();
+        update_osd();
+    }
+}
+
+static void change_palette_region(uint8_t line, int direction)
+{
+    palette_region_t region = *get_palette_region(edit_region);
+
+    if (line == OSD_LINE_REGION_SCHEME)
+    {
+        region.scheme += direction;
+        region.scheme = region.scheme >= NUMBER_OF_SCHEMES ? PALETTE_REGION_OFF : region.scheme;
+        region.scheme = region.scheme < PALETTE_REGION_OFF ? (NUMBER_OF_SCHEMES-1) : region.scheme;
+    }
+    else if (line == OSD_LINE_REGION_FIRST)
+    {
+        int first = region.first_line + (direction * PALETTE_REGION_STEP);
+        if (first >= 0 && first <= region.last_line)
+            region.first_line = first;
+    }
+    else
+    {
+        int last = region.last_line + (direction * PALETTE_REGION_STEP);
+        if (last >= region.first_line && last < PALETTE_REGION_LINES)
+            region.last_line = last;
+    }
+
+    set_palette_region(edit_region, &region);
+}
+
 static void blink(uint8_t count, uint16_t millis_on, uint16_t millis_off)
 {
   static uint8_t blink_count = 0;
@@ -737,139 +1501,259 @@ static void change_backlight_level(int direction)
     pwm_set_gpio_level(BACKLIGHT_PWM_PIN, pwm_value);
 }
 
-static void set_orientation(void)
+// Spins while the pin reads level.  Returns the spins left of the budget,
+// zero if it ran out.
+static inline __attribute__((always_inline)) uint32_t capture_wait_while(uint pin, bool level, uint32_t budget)
+{
+    while (gpio_get(pin) == level)
+    {
+        if (--budget == 0)
+            break;
+    }
+    return budget;
+}
+
+// Folds a frame into capture_stats.  The sequence is odd while fields
+// change so CAPTURE_STATS_read can tell a torn copy.
+static void __not_in_flash_func(capture_stats_end_frame)(const capture_stats_t* frame, bool complete)
+{
+    TRACE_COUNTER(CAPTURE_LATE_EDGES, (uint16_t)frame->late_edges);
+
+    capture_stats.sequence++;
+    __dmb();
+    if (complete)
+        capture_stats.frames++;
+    else
+        capture_stats.frames_aborted++;
+    capture_stats.short_lines += frame->short_lines;
+    capture_stats.late_edges += frame->late_edges;
+    capture_stats.frame_us = vsync_period_us;
+    capture_stats.line_cycles_min = frame->line_cycles_min;
+    capture_stats.line_cycles_max = frame->line_cycles_max;
+    capture_stats.pixels_min = frame->pixels_min;
+#ifdef CAPTURE_SLACK_STATS
+    capture_stats.slack_frame = frame->slack_frame;
+    if (frame->slack_frame < capture_stats.slack_min)
+        capture_stats.slack_min = frame->slack_frame;
+#endif
+    __dmb();
+    capture_stats.sequence++;
+}
+
+// One capture kernel per orientation.  Each copy has the orientation as a
+// constant, so the pixel and row steps fold to immediates and the pixel loop
+// is a GPIO read, a load, a store and a pointer add with no rotation math or
+// bounds check.  Row start pointers are stepped during HSYNC.
+//
+// Every wait is bounded.  A pixel clock that stops mid-line means an edge
+// was missed, so the rest of the line is dropped and capture resyncs on the
+// next HSYNC.  HSYNC stopping (the LCD turned off) aborts the frame until
+// the next VSYNC.  Returns false for an aborted frame.
+static inline __attribute__((always_inline)) bool capture_frame(orientation_t o)
 {
+    const int32_t base = orientation_index(o, 0, 0, DMG_PIXELS_X, DMG_PIXELS_Y);
+    const int32_t step_x = orientation_index(o, 1, 0, DMG_PIXELS_X, DMG_PIXELS_Y) - base;
+    const int32_t step_y = orientation_index(o, 0, 1, DMG_PIXELS_X, DMG_PIXELS_Y) - base;
+    uint8_t* row = &framebuffer[base];
+    capture_stats_t frame = { .pixels_min = DMG_PIXELS_X, .line_cycles_min = UINT32_MAX };
+    uint32_t late_edges = 0;
+    uint32_t line_start = 0;
+    bool complete = true;
+#ifdef CAPTURE_SLACK_STATS
+    uint32_t slack = UINT32_MAX;
+#endif
+
+    for (uint16_t y = 0; y < DMG_PIXELS_Y; y++)
+    {
+        // wait for HSYNC edge to fall.  Lines are timed from the rise, as
+        // the first pixel is read straight after the fall.
+        uint32_t budget = capture_wait_while(HSYNC_PIN, 0, CAPTURE_HSYNC_TIMEOUT_SPINS);
+        uint32_t hsync_rise = systick_hw->cvr;
+        if (budget)
+            budget = capture_wait_while(HSYNC_PIN, 1, budget);
+        if (budget == 0)
+        {
+            complete = false;
+            break;
+        }
+
+        if (y > 0)
+        {
+            uint32_t period = (line_start - hsync_rise) & SYSTICK_MASK;
+            frame.line_cycles_min = period < frame.line_cycles_min ? period : frame.line_cycles_min;
+            frame.line_cycles_max = period > frame.line_cycles_max ? period : frame.line_cycles_max;
+        }
+        line_start = hsync_rise;
+
+        uint8_t* p = row;
+        for (uint16_t x = 0; x < DMG_PIXELS_X; x++)
+        {
+            *p = SHADE_PUSH(*p, CAPTURE_SHADE(gpio_get_all()));
+            p += step_x;
+
+            // the clock pauses between lines, so there is no edge to wait
+            // for after the last pixel
+            if (x == DMG_PIXELS_X - 1)
+                break;
+
+            // wait for clock pulse to fall
+            late_edges += gpio_get(PIXEL_CLOCK_PIN);
+            budget = capture_wait_while(PIXEL_CLOCK_PIN, 0, CAPTURE_PIXEL_TIMEOUT_SPINS);
+            if (budget)
+                budget = capture_wait_while(PIXEL_CLOCK_PIN, 1, budget);
+            if (budget == 0)
+            {
+                // pixel x was stored before the wait, so the line had x + 1
+                frame.short_lines++;
+                frame.pixels_min = (x + 1) < frame.pixels_min ? (x + 1) : frame.pixels_min;
+                break;
+            }
+#ifdef CAPTURE_SLACK_STATS
+            uint32_t spins = CAPTURE_PIXEL_TIMEOUT_SPINS - budget;
+            slack = spins < slack ? spins : slack;
+#endif
+        }
+        row += step_y;
+
+        // the pause before the next line is the touch panel's only chance
+        // to be served during a frame
+        TOUCH_capture_gap();
+    }
+
+    frame.late_edges = late_edges;
+#ifdef CAPTURE_SLACK_STATS
+    frame.slack_frame = slack;
+#endif
+    capture_stats_end_frame(&frame, complete);
+    return complete;
+}
+
+#define CAPTURE_KERNEL(name, label)     static bool __no_inline_not_in_flash_func(capture_##name)(void) { return capture_frame(name); }
+ORIENTATION_TABLE(CAPTURE_KERNEL)
+
+#define CAPTURE_KERNEL_ENTRY(name, label)   [name] = capture_##name,
+static bool (* const capture_kernels[ORIENTATION_COUNT])(void) = 
+{
+    ORIENTATION_TABLE(CAPTURE_KERNEL_ENTRY)
+};
+
+// Lays out the game window and OSD for the panel mounting and switches
+// the capture kernel.  The capture interrupt is held off while the layout
+// changes so a frame is never captured half in each.
+static void set_orientation(orientation_t new_orientation)
+{
+    uint32_t interrupts = save_and_disable_interrupts();
+
+    orientation = new_orientation;
+    capture_kernel = capture_kernels[orientation];
+
     rect_gamewindow.x = 0;
     rect_gamewindow.y = 0;
-    rect_gamewindow.width = DMG_PIXELS_Y;
-    rect_gamewindow.height = DMG_PIXELS_X;
-    rect_osd.height = OSD_WIDTH;
-    rect_osd.width = OSD_HEIGHT;
+    rect_gamewindow.width = ORIENTATION_OUT_WIDTH(orientation, DMG_PIXELS_X, DMG_PIXELS_Y);
+    rect_gamewindow.height = ORIENTATION_OUT_HEIGHT(orientation, DMG_PIXELS_X, DMG_PIXELS_Y);
+    rect_osd.width = ORIENTATION_OUT_WIDTH(orientation, OSD_WIDTH, OSD_HEIGHT);
+    rect_osd.height = ORIENTATION_OUT_HEIGHT(orientation, OSD_WIDTH, OSD_HEIGHT);
 
     rect_osd.x = (rect_gamewindow.width - rect_osd.width)/2;
     rect_osd.y = (rect_gamewindow.height - rect_osd.height)/2;
+
+    memset(framebuffer, 0, sizeof(framebuffer));
+    restore_interrupts(interrupts);
+
+    // the controls panel is what the 3x scale grid leaves beside the game
+    // window:  only whole cells across it, and the part lines of the last
+    // group down it as touches there still land on that group
+    uint16_t panel_width = (VGA_MODE.width/VGA_MODE.xscale)/DMG_PIXEL_TOKENS - rect_gamewindow.width;
+    uint16_t panel_groups = (rect_gamewindow.height + CONTROLS_SCALE - 1) / CONTROLS_SCALE;
+    controls_cells = panel_width / CONTROLS_SCALE < CONTROLS_ROWS ? panel_width / CONTROLS_SCALE : CONTROLS_ROWS;
+    controls_groups = panel_groups < CONTROLS_LINE_GROUPS ? panel_groups : CONTROLS_LINE_GROUPS;
+    LAYOUT_set_panel(controls_cells, controls_groups);
+
+    OSD_set_orientation(orientation);
+    set_palette_orientation(orientation);
 }
 
-static bool rect_contains_point(const rectangle_t* rect, uint16_t x, uint16_t y)
+// Panel point from the touch controller to the touch area grid, through
+// the layout's calibration
+static void scale_touch_point(uint16_t* x, uint16_t* y)
 {
-    if (x < rect->x || x >= rect->x + rect->width || y < rect->y || y >= rect->y + rect->height)
-        return false;
-        
-    return true;
+    uint16_t width, height;
+    TOUCH_get_resolution(&width, &height);
+    int32_t grid_x = (uint32_t)*x * VGA_MODE.width / (width * TOUCH_AREA_SCALE);
+    int32_t grid_y = (uint32_t)*y * VGA_MODE.height / (height * TOUCH_AREA_SCALE);
+
+    const layout_calibration_t* c = &touch_calibration;
+    int32_t calibrated_x = (c->xx * grid_x + c->xy * grid_y) / LAYOUT_CALIBRATION_ONE + c->x_offset;
+    int32_t calibrated_y = (c->yx * grid_x + c->yy * grid_y) / LAYOUT_CALIBRATION_ONE + c->y_offset;
+    *x = calibrated_x < 0 ? 0 : (calibrated_x > UINT16_MAX ? UINT16_MAX : calibrated_x);
+    *y = calibrated_y < 0 ? 0 : (calibrated_y > UINT16_MAX ? UINT16_MAX : calibrated_y);
 }
 
-static void touchup(uint16_t x, uint16_t y)
+// Buttons under a point on the touch area grid
+static uint16_t controls_buttons_at(uint16_t x, uint16_t y)
 {
-    gpio_put(ONBOARD_LED_PIN, 0);
-    x /= 3; //TODO xscale, yscale
-    y /= 3;
-    if (rect_contains_point(&scaled_home, x, y))
-    {
-        set_button(BUTTON_HOME, BUTTON_STATE_UNPRESSED);
-        return;
-    }
-    if (rect_contains_point(&scaled_start, x, y))
-    {
-        set_button(BUTTON_START, BUTTON_STATE_UNPRESSED);
-        return;
-    }
-    if (rect_contains_point(&scaled_select, x, y))
-    {
-        set_button(BUTTON_SELECT, BUTTON_STATE_UNPRESSED);
-        return;
-    }
-    if (rect_contains_point(&scaled_a, x, y))
-    {
-        set_button(BUTTON_A, BUTTON_STATE_UNPRESSED);
-        return;
-    }
-    if (rect_contains_point(&scaled_b, x, y))
-    {
-        set_button(BUTTON_B, BUTTON_STATE_UNPRESSED);
-        return;
-    }
-    if (rect_contains_point(&scaled_up, x, y))
-    {
-        set_button(BUTTON_UP, BUTTON_STATE_UNPRESSED);
-        return;
-    }
-    if (rect_contains_point(&scaled_down, x, y))
-    {
-        set_button(BUTTON_DOWN, BUTTON_STATE_UNPRESSED);
-        return;
-    }
-    if (rect_contains_point(&scaled_left, x, y))
-    {
-        set_button(BUTTON_LEFT, BUTTON_STATE_UNPRESSED);
-        return;
-    }
-    if (rect_contains_point(&scaled_right, x, y))
+    if (x < rect_gamewindow.width)
+        return 0;
+
+    uint16_t cell = (x - rect_gamewindow.width) / CONTROLS_SCALE;
+    uint16_t group = y / CONTROLS_SCALE;
+    if (cell >= CONTROLS_ROWS || group >= CONTROLS_LINE_GROUPS)
+        return 0;
+
+    return controls_grid[group][cell];
+}
+
+// Moves touch point id onto buttons, releasing what it leaves unless
+// another point is still on it
+static void set_touch_buttons(uint8_t id, uint16_t buttons)
+{
+    uint16_t before = 0;
+    uint16_t after = 0;
+    for (uint8_t i = 0; i < MAX_TOUCH_POINTS; i++)
     {
-        set_button(BUTTON_RIGHT, BUTTON_STATE_UNPRESSED);
-        return;
+        before |= touch_buttons[i];
+        if (i == id)
+            touch_buttons[i] = buttons;
+        after |= touch_buttons[i];
     }
+
+    set_buttons(before & ~after, BUTTON_STATE_UNPRESSED);
+    set_buttons(after & ~before, BUTTON_STATE_PRESSED);
+}
+
+static void touchup(uint8_t id, uint16_t x, uint16_t y)
+{
+    TRACE_INSTANT(TOUCH_UP, x);
+    TELEMETRY_send_touch(x, y, false);
+    gpio_put(ONBOARD_LED_PIN, 0);
+    set_touch_buttons(id, 0);
 }
 
-static void touchdown(uint16_t x, uint16_t y)
+static void touchdown(uint8_t id, uint16_t x, uint16_t y)
 {
+    TRACE_INSTANT(TOUCH_DOWN, x);
+    TELEMETRY_send_touch(x, y, true);
     gpio_put(ONBOARD_LED_PIN, 1);
+    scale_touch_point(&x, &y);
+    set_touch_buttons(id, controls_buttons_at(x, y));
+}
 
-    // TODO: xscale, xycale...
-    x /= 3;
-    y /= 3;
-    
-    if (rect_contains_point(&scaled_home, x, y))
-    {
-        set_button(BUTTON_HOME, BUTTON_STATE_PRESSED);
-        return;
-    }
-    if (rect_contains_point(&scaled_start, x, y))
-    {
-        set_button(BUTTON_START, BUTTON_STATE_PRESSED);
-        return;
-    }
-    if (rect_contains_point(&scaled_select, x, y))
-    {
-        set_button(BUTTON_SELECT, BUTTON_STATE_PRESSED);
-        return;
-    }
-    if (rect_contains_point(&scaled_a, x, y))
-    {
-        set_button(BUTTON_A, BUTTON_STATE_PRESSED);
-        return;
-    }
-    if (rect_contains_point(&scaled_b, x, y))
-    {
-        set_button(BUTTON_B, BUTTON_STATE_PRESSED);
-        return;
-    }
-    if (rect_contains_point(&scaled_up, x, y))
-    {
-        set_button(BUTTON_UP, BUTTON_STATE_PRESSED);
-        return;
-    }
-    if (rect_contains_point(&scaled_down, x, y))
-    {
-        set_button(BUTTON_DOWN, BUTTON_STATE_PRESSED);
-        return;
-    }
-    if (rect_contains_point(&scaled_left, x, y))
-    {
-        set_button(BUTTON_LEFT, BUTTON_STATE_PRESSED);
-        return;
-    }
-    if (rect_contains_point(&scaled_right, x, y))
-    {
-        set_button(BUTTON_RIGHT, BUTTON_STATE_PRESSED);
+// A finger sliding across the controls rolls from button to button
+static void touchmove(uint8_t id, uint16_t x, uint16_t y)
+{
+    scale_touch_point(&x, &y);
+    uint16_t buttons = controls_buttons_at(x, y);
+    if (buttons == touch_buttons[id])
         return;
-    }
+
+    TRACE_INSTANT(TOUCH_MOVE, buttons);
+    set_touch_buttons(id, buttons);
 }
 
 // TODO: on touchup, maybe check total count of buttons pressed... if 0, clear all buttons
-// TODO: touchmove.. release if moved off
 
 
-static void gpio_callback_VIDEO(uint gpio, uint32_t events) 
+static void __not_in_flash_func(gpio_callback_VIDEO)(uint gpio, uint32_t events) 
 {
 //                  ┌─────────────────────────────────────────┐     
 // VSYNC ───────────┘                                         └───────────────────────
@@ -888,31 +1772,25 @@ static void gpio_callback_VIDEO(uint gpio, uint32_t events)
             return;
     }
 
-    uint16_t x = 0;
-    uint16_t y = 0;
-    uint32_t pos = 0;
-    uint16_t rot_x = 0;
-    uint16_t rot_y = 0;
+    static uint32_t last_vsync_us;
+    uint32_t now_us = time_us_32();
+    vsync_period_us = now_us - last_vsync_us;
+    last_vsync_us = now_us;
 
-    for (y = 0; y < DMG_PIXELS_Y; y++)
-    {
-        // wait for HSYNC edge to fall
-        while (gpio_get(HSYNC_PIN) == 0);
-        while (gpio_get(HSYNC_PIN) == 1);
-        for (x = 0; x < DMG_PIXELS_X; x++)   //DMG_PIXELS_X
-        {
-            // Rotate 270
-            rot_x = y;
-            rot_y = rect_gamewindow.height - 1 - x;
-            
-            pos = rot_x + (rot_y * rect_gamewindow.width);
+    TRACE_BEGIN(CAPTURE, 0);
+    bool complete = capture_kernel();
+    TRACE_END(CAPTURE, complete);
 
-            if (pos < DMG_PIXEL_COUNT)
-                framebuffer[pos] = (gpio_get(DATA_0_PIN) << 1) + gpio_get(DATA_1_PIN);
+    if (complete)
+    {
+        TRACE_BEGIN(VBLANK_WORK, 0);
+        if (get_ambient_enabled())
+            ambient_end_frame(framebuffer, rect_gamewindow.width, rect_gamewindow.height);
 
-            // wait for clock pulse to fall
-            while (gpio_get(PIXEL_CLOCK_PIN) == 0);
-            while (gpio_get(PIXEL_CLOCK_PIN) == 1);
-        }
+        FINGERPRINT_capture_frame(framebuffer, orientation);
+        LATENCY_frame_captured(now_us, framebuffer, rect_gamewindow.width, sizeof(framebuffer));
+        TRACE_END(VBLANK_WORK, 0);
     }
+
+    capture_busy_us += time_us_32() - now_us;
 }
\ No newline at end of file
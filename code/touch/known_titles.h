@@ -0,0 +1,12 @@
+#ifndef KNOWN_TITLES_H
+#define KNOWN_TITLES_H
+
+// Title screens recognised at power on:  X(fingerprint, scheme), sorted by
+// fingerprint.  Fingerprints are made from screenshots with
+// tools/fingerprint.py, or read from a unit's TELEMETRY_FINGERPRINT records
+// and added with its --hash; it keeps the table sorted.  Screens that are
+// not titles -- the boot logo -- are FINGERPRINT_SKIP.
+#define KNOWN_TITLE_TABLE(X) \
+    X(0x48EE86A2, FINGERPRINT_SKIP) \
+
+#endif // KNOWN_TITLES_H
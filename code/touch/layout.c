@@ -0,0 +1,150 @@
+#include <string.h>
+#include <stddef.h>
+#include "hardware/regs/addressmap.h"
+#include "layout.h"
+
+static const layout_t no_layout = { .name = "NONE" };
+
+// Into the image the layouts were loaded from -- flash, or the presets
+static const layout_t* layouts[LAYOUT_MAX_LAYOUTS];
+static uint8_t layout_count = 0;
+static int layout_index = 0;
+
+// The controls panel in cells and line groups, which changes with the
+// orientation.  A layout with an area off the panel is passed over.
+static uint8_t panel_cells = UINT8_MAX;
+static uint8_t panel_groups = UINT8_MAX;
+
+static uint32_t checksum(const uint8_t* bytes, size_t length)
+{
+    // FNV-1a, as the settings
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static bool fits(const layout_t* layout)
+{
+    for (uint8_t i = 0; i < layout->area_count; i++)
+    {
+        const layout_area_t* area = &layout->areas[i];
+        if (area->cell + area->cells > panel_cells || area->group + area->groups > panel_groups)
+            return false;
+    }
+    return true;
+}
+
+// Takes the layouts from the sector below the settings if one has been
+// written there, or else the presets
+void LAYOUT_init(void)
+{
+#if PICO_ON_DEVICE
+    if (LAYOUT_load((const void*)(XIP_BASE + LAYOUT_FLASH_OFFSET), LAYOUT_MAX_BYTES))
+        return;
+#endif
+    (void)LAYOUT_load(layout_presets, layout_presets_length);
+}
+
+// Checks a layout image and uses the layouts in it where they lie.  The
+// image has to stay put while it is in use.  Returns false, keeping the
+// layouts already loaded, if the image is not a whole and valid one.
+bool LAYOUT_load(const void* image, size_t length)
+{
+    const layout_file_t* file = (const layout_file_t*)image;
+    const uint8_t* bytes = (const uint8_t*)image;
+
+    if (((uintptr_t)image & 3) != 0 || length < sizeof(layout_file_t))
+        return false;
+    if (file->magic != LAYOUT_MAGIC || file->version != LAYOUT_VERSION)
+        return false;
+    if (file->length > length || file->length > LAYOUT_MAX_BYTES || file->length < sizeof(layout_file_t))
+        return false;
+    if (file->count == 0 || file->count > LAYOUT_MAX_LAYOUTS)
+        return false;
+    if (file->checksum != checksum(bytes + sizeof(layout_file_t), file->length - sizeof(layout_file_t)))
+        return false;
+
+    const layout_t* found[LAYOUT_MAX_LAYOUTS];
+    size_t offset = sizeof(layout_file_t);
+    for (uint16_t i = 0; i < file->count; i++)
+    {
+        if (offset + sizeof(layout_t) > file->length)
+            return false;
+
+        const layout_t* layout = (const layout_t*)(bytes + offset);
+        offset += sizeof(layout_t) + layout->area_count * sizeof(layout_area_t);
+        if (offset > file->length || layout->name[LAYOUT_NAME_LENGTH - 1] != '\0')
+            return false;
+
+        for (uint8_t area = 0; area < layout->area_count; area++)
+        {
+            if (layout->areas[area].shape > LAYOUT_SHAPE_ROUND || layout->areas[area].color > LAYOUT_COLOR_AB)
+                return false;
+        }
+        found[i] = layout;
+    }
+
+    memcpy(layouts, found, file->count * sizeof(layouts[0]));
+    layout_count = file->count;
+    if (layout_index >= layout_count)
+        layout_index = 0;
+    if (!fits(layouts[layout_index]))
+        LAYOUT_change(1);
+    return true;
+}
+
+uint8_t LAYOUT_count(void)
+{
+    return layout_count;
+}
+
+const layout_t* LAYOUT_get(void)
+{
+    return layout_count ? layouts[layout_index] : &no_layout;
+}
+
+// Steps to the next layout that fits the panel.  If none does, the index
+// comes back round to where it was.
+void LAYOUT_change(int direction)
+{
+    for (uint8_t tries = 0; tries < layout_count; tries++)
+    {
+        layout_index += direction;
+        if (layout_index < 0)
+            layout_index = layout_count - 1;
+        else if (layout_index >= layout_count)
+            layout_index = 0;
+
+        if (fits(layouts[layout_index]))
+            return;
+    }
+}
+
+int LAYOUT_get_index(void)
+{
+    return layout_index;
+}
+
+void LAYOUT_set_index(int index)
+{
+    if (index >= 0 && index < layout_count && fits(layouts[index]))
+        layout_index = index;
+}
+
+// Sets the panel size the layouts have to fit, moving on from the current
+// one if it no longer does
+void LAYOUT_set_panel(uint8_t cells, uint8_t groups)
+{
+    panel_cells = cells;
+    panel_groups = groups;
+    if (layout_count && !fits(layouts[layout_index]))
+        LAYOUT_change(1);
+}
+
+const char* LAYOUT_get_name(void)
+{
+    return LAYOUT_get()->name;
+}
@@ -0,0 +1,105 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+
+// On-screen controls layouts.  A layout places touch areas on the controls
+// panel, in cells of CONTROLS_SCALE pixels on the 3x scale grid:  line
+// groups run down the panel and cells across it from the game window.  Each
+// area says which buttons it presses, its shape and how it is drawn, and
+// the layout carries a calibration for the touch points.  The panel is
+// narrower with the game window upright (0 and 180) than sideways, so only
+// the layouts whose areas are all on it are offered (LAYOUT_set_panel).
+//
+// Layouts are stored as one little endian image (see tools/layout_gen.py),
+//
+//   layout_file_t  layout_t  layout_area_t[area_count]  layout_t  ...
+//
+// with every record a whole number of words, so they are used where they
+// lie in XIP flash rather than copied out.  An image written to the sector
+// below the settings (LAYOUT_FLASH_OFFSET) replaces the presets built into
+// the firmware, so layouts can change without a reflash of the program.
+#define LAYOUT_MAGIC            (0x594C4247)    // "GBLY"
+#define LAYOUT_VERSION          (1)
+#define LAYOUT_FLASH_OFFSET     (PICO_FLASH_SIZE_BYTES - 2 * FLASH_SECTOR_SIZE)
+#define LAYOUT_MAX_BYTES        (FLASH_SECTOR_SIZE)
+#define LAYOUT_MAX_LAYOUTS      (8)
+#define LAYOUT_NAME_LENGTH      (12)            // NUL padded, so 11 characters at most
+#define LAYOUT_CALIBRATION_ONE  (256)           // 1.0 in the calibration matrix
+
+typedef enum
+{
+    LAYOUT_SHAPE_RECT = 0,
+    LAYOUT_SHAPE_ROUND,         // the cells whose centres are inside the ellipse
+} layout_shape_t;
+
+// Which control scheme color an area is drawn in.  Cells of an area drawn
+// in LAYOUT_COLOR_NONE are touch only, e.g. the d-pad corners.
+typedef enum
+{
+    LAYOUT_COLOR_NONE = 0,
+    LAYOUT_COLOR_OTHER,         // control_scheme_t.button_color_other
+    LAYOUT_COLOR_AB,            // control_scheme_t.button_color_ab
+} layout_color_t;
+
+typedef struct layout_file_t
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;             // layouts
+    uint32_t length;            // bytes, this header included
+    uint32_t checksum;          // FNV-1a over the bytes after this header
+} layout_file_t;
+
+// Maps a touch point on the 3x scale grid to the controls panel grid:
+//   x' = (xx * x + xy * y) / LAYOUT_CALIBRATION_ONE + x_offset
+//   y' = (yx * x + yy * y) / LAYOUT_CALIBRATION_ONE + y_offset
+typedef struct layout_calibration_t
+{
+    int16_t xx;
+    int16_t xy;
+    int16_t yx;
+    int16_t yy;
+    int16_t x_offset;
+    int16_t y_offset;
+} layout_calibration_t;
+
+typedef struct layout_area_t
+{
+    uint8_t cell;               // across the panel, from the game window
+    uint8_t group;              // output line group
+    uint8_t cells;
+    uint8_t groups;
+    uint16_t buttons;           // bit per controller_button_t
+    uint8_t shape;              // layout_shape_t
+    uint8_t color;              // layout_color_t
+} layout_area_t;
+
+typedef struct layout_t
+{
+    char name[LAYOUT_NAME_LENGTH];
+    layout_calibration_t calibration;
+    uint8_t area_count;
+    uint8_t reserved[3];
+    layout_area_t areas[];      // later areas win where they overlap
+} layout_t;
+
+_Static_assert(sizeof(layout_file_t) % 4 == 0 && sizeof(layout_t) % 4 == 0 && sizeof(layout_area_t) % 4 == 0,
+               "layout records must be whole words");
+
+// Built in, from tools/layout_gen.py
+extern const uint32_t layout_presets[];
+extern const uint32_t layout_presets_length;
+
+void LAYOUT_init(void);
+bool LAYOUT_load(const void* image, size_t length);
+uint8_t LAYOUT_count(void);
+const layout_t* LAYOUT_get(void);
+void LAYOUT_change(int direction);
+int LAYOUT_get_index(void);
+void LAYOUT_set_index(int index);
+void LAYOUT_set_panel(uint8_t cells, uint8_t groups);
+const char* LAYOUT_get_name(void);
+
+#endif // LAYOUT_H
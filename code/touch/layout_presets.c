@@ -0,0 +1,33 @@
+// Generated by tools/layout_gen.py -- do not edit by hand
+// STANDARD, LEFT HANDED, COMPACT, LARGE
+
+#include "layout.h"
+
+const uint32_t layout_presets[] = 
+{
+    0x594C4247, 0x00040001, 0x00000220, 0xC82A6FDB, 0x4E415453, 0x44524144,
+    0x00000000, 0x00000100, 0x01000000, 0x00000000, 0x0000000D, 0x02010100,
+    0x01000008, 0x02010700, 0x01000100, 0x02010D00, 0x01000004, 0x02020104,
+    0x02000001, 0x02020406, 0x02000002, 0x02020B04, 0x01000010, 0x02020B08,
+    0x01000020, 0x02020D06, 0x01000040, 0x02020906, 0x01000080, 0x02020904,
+    0x00000090, 0x02020D04, 0x00000050, 0x02020908, 0x000000A0, 0x02020D08,
+    0x00000060, 0x5446454C, 0x4E414820, 0x00444544, 0x00000100, 0x01000000,
+    0x00000000, 0x0000000D, 0x02010D00, 0x01000008, 0x02010700, 0x01000100,
+    0x02010100, 0x01000004, 0x02020D04, 0x02000001, 0x02020A06, 0x02000002,
+    0x02020304, 0x01000010, 0x02020308, 0x01000020, 0x02020106, 0x01000080,
+    0x02020506, 0x01000040, 0x02020504, 0x00000050, 0x02020104, 0x00000090,
+    0x02020508, 0x00000060, 0x02020108, 0x000000A0, 0x504D4F43, 0x00544341,
+    0x00000000, 0x00000100, 0x01000000, 0x00000000, 0x0000000D, 0x02010100,
+    0x01000008, 0x02010700, 0x01000100, 0x02010D00, 0x01000004, 0x02020101,
+    0x02000001, 0x02020303, 0x02000002, 0x02020B01, 0x01000010, 0x02020B05,
+    0x01000020, 0x02020D03, 0x01000040, 0x02020903, 0x01000080, 0x02020901,
+    0x00000090, 0x02020D01, 0x00000050, 0x02020905, 0x000000A0, 0x02020D05,
+    0x00000060, 0x4752414C, 0x00000045, 0x00000000, 0x00000100, 0x01000000,
+    0x00000000, 0x0000000D, 0x03010000, 0x01000008, 0x03010600, 0x01000100,
+    0x03010D00, 0x01000004, 0x04040001, 0x02010001, 0x04040305, 0x02010002,
+    0x03030A03, 0x01000010, 0x03030A09, 0x01000020, 0x03030D06, 0x01000040,
+    0x03030706, 0x01000080, 0x03030703, 0x00000090, 0x03030D03, 0x00000050,
+    0x03030709, 0x000000A0, 0x03030D09, 0x00000060,
+};
+
+const uint32_t layout_presets_length = sizeof(layout_presets);
@@ -3,11 +3,14 @@
 #include <stdint.h>
 
 static uint8_t osd_pixel_buff[OSD_CHARS_PER_LINE];   // TODO:  OSD_get_pixel_buff?
-static char osd_text[OSD_LINES][OSD_CHARS_PER_LINE+1];
+static char osd_text[OSD_PAGES][OSD_LINES][OSD_CHARS_PER_LINE+1];
 static bool osd_enabled = false;
-static int active_line = 0;
+static uint8_t page = 0;
+static int active_line[OSD_PAGES] = {0};
+static bool line_dirty[OSD_LINES];      // lines of the shown page to redraw
 //static uint8_t* framebuffer = NULL;
-static uint8_t framebuffer[OSD_HEIGHT*OSD_WIDTH] = {0};
+static uint8_t framebuffer[OSD_HEIGHT*OSD_WIDTH] = {0};  // output order, see OSD_set_orientation
+static orientation_t osd_orientation = ORIENTATION_0;
 
 typedef struct 
 {
@@ -564,6 +567,34 @@ static osd_char_data_t osd_letters[] =
             0b00000000
         }
     },
+    { 
+        .osd_char = '.', 
+        .data = 
+        {
+            0b00000000,
+            0b00000000,
+            0b00000000,
+            0b00000000,
+            0b00000000,
+            0b00011000,
+            0b00011000,
+            0b00000000
+        }
+    },
+    { 
+        .osd_char = '%', 
+        .data = 
+        {
+            0b00000000,
+            0b00110010,
+            0b00110100,
+            0b00001000,
+            0b00010000,
+            0b00100110,
+            0b00000110,
+            0b00000000
+        }
+    },
     { .osd_char = '\0', .data = 0 }  // Keep this
 };
 
@@ -571,11 +602,13 @@ static osd_char_data_t osd_letters[] =
 // PRIVATE FUNCTION PROTOTYPES
 //**********************************************************************************************
 static uint8_t* get_char_data(char lookup_char);
+static void draw_line(int y);
+static void mark_all_dirty(void);
 
 //**********************************************************************************************
 // PUBLIC FUNCTIONS
 //**********************************************************************************************
-bool OSD_is_enabled(void)
+bool __not_in_flash_func(OSD_is_enabled)(void)
 {
     return osd_enabled;
 }
@@ -585,47 +618,62 @@ void OSD_toggle(void)
     osd_enabled = !osd_enabled;
 }
 
-void OSD_set_line_text(uint8_t line_index, const char* text)
+// Lines of the shown page are only redrawn by OSD_update when their text
+// changes, so a page rewritten every frame costs little
+void OSD_set_line_text(uint8_t page_index, uint8_t line_index, const char* text)
 {
-    if (line_index >= OSD_LINES)
+    if (page_index >= OSD_PAGES || line_index >= OSD_LINES)
         return;
 
+    char* line = osd_text[page_index][line_index];
+    size_t length = strlen(text);
+    bool changed = false;
     for (int i = 0; i < OSD_CHARS_PER_LINE; i++)
     {
-        osd_text[line_index][i] = i < strlen(text) ? text[i] : ' ';
+        char c = i < length ? text[i] : ' ';
+        changed |= (line[i] != c);
+        line[i] = c;
     }
-    osd_text[line_index][OSD_CHARS_PER_LINE] = '\0';
+    line[OSD_CHARS_PER_LINE] = '\0';
+
+    if (changed && page_index == page)
+        line_dirty[line_index] = true;
 }
 
 void OSD_update(void)
 {
-    int pos = 0;
-    uint8_t color1 = 0x00;
-    uint8_t color2 = 0x3C;
     for (int y = 0; y < OSD_LINES; y++)
     {
-        for (int n = 0; n < OSD_CHAR_HEIGHT; n++)
+        if (line_dirty[y])
         {
-            for (int x = 0; x < OSD_CHARS_PER_LINE; x++)
-            {
-                char myChar = osd_text[y][x];
-                uint8_t* char_data = get_char_data(myChar);
-                for (int o = OSD_CHAR_WIDTH-1; o >= 0; o--)
-                {
-                    if (y == active_line)
-                    {
-                        framebuffer[pos++] = (((char_data[n] >> o) & 1) == 0) ? color2 : color1;
-                    }
-                    else
-                    {
-                        framebuffer[pos++] = (((char_data[n] >> o) & 1) == 0) ? color1 : color2;
-                    }
-                }
-            }
+            line_dirty[y] = false;
+            draw_line(y);
         }
     }
 }
 
+void OSD_set_orientation(orientation_t orientation)
+{
+    osd_orientation = orientation;
+    mark_all_dirty();
+    OSD_update();
+}
+
+void OSD_set_page(uint8_t page_index)
+{
+    if (page_index >= OSD_PAGES || page_index == page)
+        return;
+
+    page = page_index;
+    mark_all_dirty();
+    OSD_update();
+}
+
+uint8_t OSD_get_page(void)
+{
+    return page;
+}
+
 // uint8_t OSD_get_width(void)
 // {
 //     return OSD_WIDTH;
@@ -653,24 +701,35 @@ void OSD_update(void)
 
 void OSD_change_line(int direction)
 {
-    active_line += direction;
-    active_line = active_line >= OSD_LINES ? 0 : active_line;
-    active_line = active_line < 0 ? OSD_LINES-1 : active_line;
+    int line = active_line[page] + direction;
+    line = line >= OSD_LINES ? 0 : line;
+    line = line < 0 ? OSD_LINES-1 : line;
+    OSD_set_active_line(line);
+}
+
+void OSD_set_active_line(uint8_t line_index)
+{
+    if (line_index >= OSD_LINES)
+        return;
 
+    line_dirty[active_line[page]] = true;
+    line_dirty[line_index] = true;
+    active_line[page] = line_index;
     OSD_update();
 }
 
 uint8_t OSD_get_active_line(void)
 {
-    return (uint8_t)active_line;
+    return (uint8_t)active_line[page];
 }
 
 uint8_t OSD_get_pixel(uint8_t x, uint8_t y)
 {
-    int pos = x + (y * OSD_WIDTH);
-    if (pos >= sizeof(framebuffer))
+    if (x >= OSD_WIDTH || y >= OSD_HEIGHT)
         return 0;
 
+    int pos = orientation_index(osd_orientation, x, y, OSD_WIDTH, OSD_HEIGHT);
+
     return framebuffer[pos];
 }
 
@@ -697,3 +756,45 @@ static uint8_t* get_char_data(char lookup_char)
     return osd_letters[0].data;
 }
 
+// Text is drawn in reading order and each pixel stepped into place in the
+// rotated framebuffer, so the render loop reads the OSD sequentially
+static void draw_line(int y)
+{
+    uint8_t color1 = 0x00;
+    uint8_t color2 = 0x3C;
+    int32_t base = orientation_index(osd_orientation, 0, 0, OSD_WIDTH, OSD_HEIGHT);
+    int32_t step_x = orientation_index(osd_orientation, 1, 0, OSD_WIDTH, OSD_HEIGHT) - base;
+    int32_t step_y = orientation_index(osd_orientation, 0, 1, OSD_WIDTH, OSD_HEIGHT) - base;
+    uint8_t* row = &framebuffer[base + (y * OSD_CHAR_HEIGHT * step_y)];
+    const char* text = osd_text[page][y];
+
+    for (int n = 0; n < OSD_CHAR_HEIGHT; n++)
+    {
+        uint8_t* p = row;
+        for (int x = 0; x < OSD_CHARS_PER_LINE; x++)
+        {
+            char myChar = text[x];
+            uint8_t* char_data = get_char_data(myChar);
+            for (int o = OSD_CHAR_WIDTH-1; o >= 0; o--)
+            {
+                if (y == active_line[page])
+                {
+                    *p = (((char_data[n] >> o) & 1) == 0) ? color2 : color1;
+                }
+                else
+                {
+                    *p = (((char_data[n] >> o) & 1) == 0) ? color1 : color2;
+                }
+                p += step_x;
+            }
+        }
+        row += step_y;
+    }
+}
+
+static void mark_all_dirty(void)
+{
+    for (int y = 0; y < OSD_LINES; y++)
+        line_dirty[y] = true;
+}
+
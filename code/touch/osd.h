@@ -4,24 +4,34 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include "orientation.h"
 
 #define OSD_CHAR_WIDTH      (7)
 #define OSD_CHAR_HEIGHT     (8)
-#define OSD_LINES           (4)
+#ifdef DOT_MATRIX_MODE
+#define OSD_LINES           (16)
+#else
+#define OSD_LINES           (15)
+#endif
 #define OSD_CHARS_PER_LINE  (18)
+#define OSD_PAGES           (2)
 #define OSD_HEIGHT          (OSD_LINES*OSD_CHAR_HEIGHT)
 #define OSD_WIDTH           (OSD_CHAR_WIDTH*OSD_CHARS_PER_LINE)
 
 bool OSD_is_enabled(void);
 void OSD_toggle(void);
-void OSD_set_line_text(uint8_t line_index, const char* text);
+void OSD_set_line_text(uint8_t page_index, uint8_t line_index, const char* text);
 void OSD_update(void);
+void OSD_set_orientation(orientation_t orientation);
+void OSD_set_page(uint8_t page_index);
+uint8_t OSD_get_page(void);
 // uint8_t OSD_get_width(void);
 // uint8_t OSD_get_height(void);
 // uint8_t OSD_get_char_width(void);
 // uint8_t OSD_get_char_height(void);
 //uint8_t OSD_get_line_count(void);
 void OSD_change_line(int direction);
+void OSD_set_active_line(uint8_t line_index);
 uint8_t OSD_get_active_line(void);
 uint8_t OSD_get_pixel(uint8_t x, uint8_t y);
 uint8_t* OSD_get_framebuffer(void);
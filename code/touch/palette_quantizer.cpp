@@ -0,0 +1,216 @@
+// Build time palette quantizer
+//
+// Maps every color_schemes[] entry to the perceptually nearest set of four
+// distinct RGB222 tokens.  The tables are evaluated by the compiler and
+// only the finished tokens end up in flash.
+
+#include <stdint.h>
+
+extern "C" {
+#include "colors.h"
+#include "pico/scanvideo.h"
+}
+
+#include "color_scheme_table.h"
+
+namespace {
+
+constexpr int RGB222_LEVELS = 4;
+constexpr int RGB222_COLORS = RGB222_LEVELS * RGB222_LEVELS * RGB222_LEVELS;
+constexpr int SHADES = 4;
+constexpr int CANDIDATES = 8;   // nearest tokens considered per shade
+
+struct rgb_t
+{
+    int r;
+    int g;
+    int b;
+};
+
+struct quad_t
+{
+    uint16_t tokens[SHADES];
+    bool separated;
+};
+
+struct scheme_quads_t
+{
+    quad_t quads[NUMBER_OF_SCHEMES];
+};
+
+constexpr rgb_t unpack(uint32_t color)
+{
+    return { (int)((color >> 16) & 0xFF), (int)((color >> 8) & 0xFF), (int)(color & 0xFF) };
+}
+
+// RGB222 level n is driven as n * 85 on the panel
+constexpr rgb_t level_color(int index)
+{
+    return { ((index >> 4) & 3) * 85, ((index >> 2) & 3) * 85, (index & 3) * 85 };
+}
+
+constexpr uint16_t level_token(int index)
+{
+    return (uint16_t)( ( (index & 3) << PICO_SCANVIDEO_PIXEL_BSHIFT )
+                     | ( ((index >> 2) & 3) << PICO_SCANVIDEO_PIXEL_GSHIFT )
+                     | ( ((index >> 4) & 3) << PICO_SCANVIDEO_PIXEL_RSHIFT ) );
+}
+
+// "Redmean" weighted distance -- a cheap approximation of perceived
+// difference that weights red/blue by how bright the red component is.
+constexpr int distance(rgb_t a, rgb_t b)
+{
+    int rmean = (a.r + b.r) / 2;
+    int dr = a.r - b.r;
+    int dg = a.g - b.g;
+    int db = a.b - b.b;
+    return (((512 + rmean) * dr * dr) >> 8) + 4 * dg * dg + (((767 - rmean) * db * db) >> 8);
+}
+
+constexpr int luma(rgb_t c)
+{
+    return 299 * c.r + 587 * c.g + 114 * c.b;
+}
+
+struct candidates_t
+{
+    int index[CANDIDATES];
+    int cost[CANDIDATES];
+};
+
+constexpr candidates_t nearest_levels(uint32_t color)
+{
+    candidates_t best = {};
+    for (int i = 0; i < CANDIDATES; i++)
+        best.cost[i] = 0x7FFFFFFF;
+
+    rgb_t target = unpack(color);
+    for (int index = 0; index < RGB222_COLORS; index++)
+    {
+        int cost = distance(target, level_color(index));
+        for (int slot = 0; slot < CANDIDATES; slot++)
+        {
+            if (cost < best.cost[slot])
+            {
+                for (int move = CANDIDATES - 1; move > slot; move--)
+                {
+                    best.cost[move] = best.cost[move - 1];
+                    best.index[move] = best.index[move - 1];
+                }
+                best.cost[slot] = cost;
+                best.index[slot] = index;
+                break;
+            }
+        }
+    }
+    return best;
+}
+
+// Shades must stay distinct and keep the brightness order of the source
+// palette.  Checks the newest pick against the ones already made.
+constexpr bool separated(const int (&source_luma)[SHADES], const int (&pick)[SHADES], int shade)
+{
+    for (int other = 0; other < shade; other++)
+    {
+        if (pick[other] == pick[shade])
+            return false;
+
+        int source = source_luma[other] - source_luma[shade];
+        int shown = luma(level_color(pick[other])) - luma(level_color(pick[shade]));
+        if ((source > 0 && shown < 0) || (source < 0 && shown > 0))
+            return false;
+    }
+    return true;
+}
+
+struct search_t
+{
+    candidates_t candidates[SHADES];
+    int source_luma[SHADES];
+    int pick[SHADES];
+    int best_cost;
+    quad_t best;
+};
+
+// Depth first over each shade's nearest candidates, pruned by the best cost so far
+constexpr void search(search_t& state, int shade, int cost)
+{
+    if (shade == SHADES)
+    {
+        state.best_cost = cost;
+        for (int i = 0; i < SHADES; i++)
+            state.best.tokens[i] = level_token(state.pick[i]);
+        state.best.separated = true;
+        return;
+    }
+
+    for (int slot = 0; slot < CANDIDATES; slot++)
+    {
+        int next_cost = cost + state.candidates[shade].cost[slot];
+        if (next_cost >= state.best_cost)
+            break;  // candidates are sorted, the rest cost more
+
+        state.pick[shade] = state.candidates[shade].index[slot];
+        if (separated(state.source_luma, state.pick, shade))
+            search(state, shade + 1, next_cost);
+    }
+}
+
+constexpr quad_t quantize(const uint32_t (&colors)[SHADES])
+{
+    search_t state = {};
+    for (int shade = 0; shade < SHADES; shade++)
+    {
+        state.candidates[shade] = nearest_levels(colors[shade]);
+        state.source_luma[shade] = luma(unpack(colors[shade]));
+    }
+    state.best_cost = 0x7FFFFFFF;
+
+    search(state, 0, 0);
+    return state.best;
+}
+
+#define COLOR_SCHEME_QUANTIZE(scheme, c1, c2, c3, c4)  \
+    {                                                   \
+        const uint32_t colors[SHADES] = { c1, c2, c3, c4 }; \
+        table.quads[scheme] = quantize(colors);         \
+    }
+
+constexpr scheme_quads_t quantize_all(void)
+{
+    scheme_quads_t table = {};
+    COLOR_SCHEME_TABLE(COLOR_SCHEME_QUANTIZE)
+    return table;
+}
+
+constexpr scheme_quads_t scheme_quads = quantize_all();
+
+constexpr bool all_separated(void)
+{
+    for (int scheme = 0; scheme < NUMBER_OF_SCHEMES; scheme++)
+    {
+        if (!scheme_quads.quads[scheme].separated)
+            return false;
+    }
+    return true;
+}
+
+static_assert(all_separated(), "palette quantizer could not find distinct RGB222 shades for every scheme");
+
+#define COLOR_SCHEME_TOKENS(scheme, c1, c2, c3, c4)    \
+    { scheme_quads.quads[scheme].tokens[0], scheme_quads.quads[scheme].tokens[1], \
+      scheme_quads.quads[scheme].tokens[2], scheme_quads.quads[scheme].tokens[3] },
+
+} // namespace
+
+// Runtime entry point for colors that only exist once the user picks
+// settings (e.g. frame blend mixes), using the same metric as the tables
+extern "C" uint16_t rgb888_to_rgb222_nearest(uint32_t color)
+{
+    return level_token(nearest_levels(color).index[0]);
+}
+
+extern "C" const uint16_t quantized_scheme_tokens[NUMBER_OF_SCHEMES][4] =
+{
+    COLOR_SCHEME_TABLE(COLOR_SCHEME_TOKENS)
+};
@@ -0,0 +1,100 @@
+#include "render_stats.h"
+
+typedef struct line_stats_t
+{
+    uint32_t lines;
+    uint32_t missed;
+    uint32_t worst;
+    uint64_t total;
+    uint32_t bins[RENDER_STATS_BINS];
+} line_stats_t;
+
+static line_stats_t __scratch_x("render_stats") line_stats[RENDER_LINE_TYPES];
+static volatile uint32_t __scratch_x("render_stats") busy_cycles;    // all lines, never reset
+static volatile bool reset_requested = false;
+
+// Must run on core1 -- each core has its own SysTick
+void RENDER_STATS_init(void)
+{
+    systick_hw->rvr = RENDER_STATS_MASK;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+    RENDER_STATS_reset();
+}
+
+void __not_in_flash_func(RENDER_STATS_record)(render_line_type_t type, uint32_t start, bool missed)
+{
+    uint32_t cycles = (start - systick_hw->cvr) & RENDER_STATS_MASK;
+    busy_cycles += cycles;
+
+    // cleared here so a reset from core0 never races an update
+    if (reset_requested)
+    {
+        for (int i = 0; i < RENDER_LINE_TYPES; i++)
+        {
+            line_stats_t* clear = &line_stats[i];
+            clear->lines = 0;
+            clear->missed = 0;
+            clear->worst = 0;
+            clear->total = 0;
+            for (int bin = 0; bin < RENDER_STATS_BINS; bin++)
+                clear->bins[bin] = 0;
+        }
+        reset_requested = false;
+    }
+
+    line_stats_t* stats = &line_stats[type];
+    uint32_t bin = cycles >> RENDER_STATS_BIN_SHIFT;
+    stats->bins[bin < RENDER_STATS_BINS ? bin : RENDER_STATS_BINS - 1]++;
+    stats->lines++;
+    stats->total += cycles;
+    if (cycles > stats->worst)
+        stats->worst = cycles;
+    if (missed)
+        stats->missed++;
+}
+
+void RENDER_STATS_get(render_line_type_t type, render_stats_summary_t* summary)
+{
+    const line_stats_t* stats = &line_stats[type];
+    uint32_t lines = stats->lines;
+
+    summary->lines = lines;
+    summary->missed = stats->missed;
+    summary->worst = stats->worst;
+    summary->mean = lines ? (uint32_t)(stats->total / lines) : 0;
+    summary->p99 = 0;
+    if (lines == 0)
+        return;
+
+    // walk down from the slowest bin until 1% of the lines are above it
+    uint32_t above = 0;
+    int bin = RENDER_STATS_BINS - 1;
+    while (bin > 0 && (above + stats->bins[bin]) <= lines / 100)
+    {
+        above += stats->bins[bin];
+        bin--;
+    }
+    summary->p99 = (bin == RENDER_STATS_BINS - 1) ? summary->worst : (uint32_t)(bin + 1) << RENDER_STATS_BIN_SHIFT;
+    if (summary->p99 > summary->worst)
+        summary->p99 = summary->worst;
+}
+
+// Bin n counts renders of n << RENDER_STATS_BIN_SHIFT cycles and up
+void RENDER_STATS_get_bins(render_line_type_t type, uint32_t bins[RENDER_STATS_BINS])
+{
+    const line_stats_t* stats = &line_stats[type];
+    for (int bin = 0; bin < RENDER_STATS_BINS; bin++)
+        bins[bin] = stats->bins[bin];
+}
+
+// Free running total of render cycles -- the change over a period gives
+// core1's render load
+uint32_t RENDER_STATS_get_busy_cycles(void)
+{
+    return busy_cycles;
+}
+
+void RENDER_STATS_reset(void)
+{
+    reset_requested = true;
+}
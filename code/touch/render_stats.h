@@ -0,0 +1,45 @@
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+#include "pico/stdlib.h"
+#include "hardware/structs/systick.h"
+
+// Scanline render cost on core1.  Each render_scanline call is timed with
+// core1's SysTick and binned by line type.  The histograms sit in core1's
+// scratch bank; other cores only read summaries, which may be a line stale.
+#define RENDER_STATS_BIN_SHIFT  (9)     // 512 cycles per bin
+#define RENDER_STATS_BINS       (48)    // last bin also holds anything slower
+#define RENDER_STATS_MASK       (0x00FFFFFF)
+
+typedef enum
+{
+    RENDER_LINE_SOLID = 0,
+    RENDER_LINE_GAME,
+    RENDER_LINE_GAME_OSD,
+    RENDER_LINE_GAME_CONTROLS,
+    RENDER_LINE_TYPES
+} render_line_type_t;
+
+typedef struct render_stats_summary_t
+{
+    uint32_t lines;
+    uint32_t missed;        // finished after scanvideo had moved past the line
+    uint32_t mean;          // cycles
+    uint32_t p99;           // cycles, upper edge of the bin
+    uint32_t worst;         // cycles
+} render_stats_summary_t;
+
+void RENDER_STATS_init(void);
+void RENDER_STATS_record(render_line_type_t type, uint32_t start, bool missed);
+void RENDER_STATS_get(render_line_type_t type, render_stats_summary_t* summary);
+void RENDER_STATS_get_bins(render_line_type_t type, uint32_t bins[RENDER_STATS_BINS]);
+uint32_t RENDER_STATS_get_busy_cycles(void);
+void RENDER_STATS_reset(void);
+
+// SysTick counts down, so cycles elapsed are start - now
+static inline uint32_t RENDER_STATS_now(void)
+{
+    return systick_hw->cvr;
+}
+
+#endif // RENDER_STATS_H
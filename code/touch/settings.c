@@ -0,0 +1,124 @@
+#include <string.h>
+#include <stddef.h>
+#include "pico/multicore.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "settings.h"
+#include "trace.h"
+
+#define SETTINGS_MAGIC          (0x4C584247)    // "GBXL"
+#define SETTINGS_VERSION        (1)
+#define SETTINGS_FLASH_OFFSET   (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+
+typedef struct settings_t
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    game_profile_t profiles[SETTINGS_PROFILES];     // most recently saved first
+    uint32_t checksum;
+} settings_t;
+
+// Flash is programmed in whole pages
+typedef union settings_page_t
+{
+    settings_t settings;
+    uint8_t bytes[(sizeof(settings_t) + FLASH_PAGE_SIZE - 1) & ~(FLASH_PAGE_SIZE - 1)];
+} settings_page_t;
+
+static const settings_t* const flash_settings = (const settings_t*)(XIP_BASE + SETTINGS_FLASH_OFFSET);
+static settings_page_t page;
+
+static uint32_t checksum(const settings_t* settings)
+{
+    // FNV-1a over everything before the checksum
+    const uint8_t* p = (const uint8_t*)settings;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(settings_t, checksum); i++)
+    {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+    return hash;
+}
+
+void SETTINGS_init(void)
+{
+    memset(&page, 0xFF, sizeof(page));
+    if (flash_settings->magic == SETTINGS_MAGIC
+        && flash_settings->version == SETTINGS_VERSION
+        && flash_settings->count <= SETTINGS_PROFILES
+        && flash_settings->checksum == checksum(flash_settings))
+    {
+        page.settings = *flash_settings;
+    }
+    else
+    {
+        memset(&page.settings, 0, sizeof(page.settings));
+        page.settings.magic = SETTINGS_MAGIC;
+        page.settings.version = SETTINGS_VERSION;
+    }
+}
+
+static game_profile_t* find_profile(uint32_t game_id)
+{
+    for (int i = 0; i < page.settings.count; i++)
+    {
+        if (page.settings.profiles[i].game_id == game_id)
+            return &page.settings.profiles[i];
+    }
+    return NULL;
+}
+
+bool SETTINGS_has_profile(uint32_t game_id)
+{
+    return find_profile(game_id) != NULL;
+}
+
+// Loads the game's profile, falling back to the default one.  Returns false
+// when neither has been saved.
+bool SETTINGS_apply(uint32_t game_id)
+{
+    const game_profile_t* profile = find_profile(game_id);
+    if (profile == NULL)
+        profile = find_profile(SETTINGS_DEFAULT_GAME);
+    if (profile == NULL)
+        return false;
+
+    set_palette(profile->scheme, profile->regions);
+    return true;
+}
+
+// Stores the current palette settings for the game.  Writing the sector
+// pauses core1 and the capture interrupt for the erase (tens of ms), so
+// this is only called when the user leaves the menu.
+void SETTINGS_save(uint32_t game_id)
+{
+    game_profile_t profile = { .game_id = game_id, .scheme = get_scheme_index() };
+    for (int region = 1; region < PALETTE_REGIONS; region++)
+    {
+        profile.regions[region - 1] = *get_palette_region(region);
+    }
+
+    // move to the front, dropping the least recently saved profile when full
+    game_profile_t* existing = find_profile(game_id);
+    int shift = existing != NULL ? existing - page.settings.profiles : page.settings.count;
+    if (shift >= SETTINGS_PROFILES)
+        shift = SETTINGS_PROFILES - 1;
+    else if (existing == NULL)
+        page.settings.count++;
+    memmove(&page.settings.profiles[1], &page.settings.profiles[0], shift * sizeof(game_profile_t));
+    page.settings.profiles[0] = profile;
+    page.settings.checksum = checksum(&page.settings);
+
+    if (memcmp(flash_settings, &page.settings, sizeof(settings_t)) == 0)
+        return;
+
+    TRACE_BEGIN(FLASH_WRITE, 0);
+    multicore_lockout_start_blocking();
+    uint32_t interrupts = save_and_disable_interrupts();
+    flash_range_erase(SETTINGS_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+    flash_range_program(SETTINGS_FLASH_OFFSET, page.bytes, sizeof(page.bytes));
+    restore_interrupts(interrupts);
+    multicore_lockout_end_blocking();
+    TRACE_END(FLASH_WRITE, 0);
+}
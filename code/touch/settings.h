@@ -0,0 +1,24 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include "pico/stdlib.h"
+#include "colors.h"
+
+// Per-game settings kept in the last sector of flash.  Profiles are keyed
+// by a game id; SETTINGS_DEFAULT_GAME is used when the game is not known.
+#define SETTINGS_PROFILES       (32)
+#define SETTINGS_DEFAULT_GAME   (0)
+
+typedef struct game_profile_t
+{
+    uint32_t game_id;
+    int8_t scheme;
+    palette_region_t regions[PALETTE_REGIONS - 1];
+} game_profile_t;
+
+void SETTINGS_init(void);
+bool SETTINGS_has_profile(uint32_t game_id);
+bool SETTINGS_apply(uint32_t game_id);
+void SETTINGS_save(uint32_t game_id);
+
+#endif // SETTINGS_H
@@ -0,0 +1,202 @@
+#include "telemetry.h"
+
+#ifdef TELEMETRY_ENABLED
+
+#include <string.h>
+#include "capture_stats.h"
+#include "render_stats.h"
+#if PICO_ON_DEVICE
+#include "pico/stdio_usb.h"
+#include "tusb.h"
+#else
+#include <stdio.h>
+#endif
+
+#define FRAME_OVERHEAD  (7)     // sync, version, type, sequence, length, crc
+
+_Static_assert(TELEMETRY_RENDER_BINS == RENDER_STATS_BINS, "telemetry_render_t bins");
+_Static_assert(sizeof(telemetry_render_t) <= 255, "telemetry_render_t too big for a frame");
+
+static uint8_t ring[TELEMETRY_RING_BYTES];
+static uint32_t ring_head;      // bytes ever queued
+static uint32_t ring_tail;      // bytes ever written out
+static uint8_t sequence;
+static telemetry_transport_t transport;
+
+// Render counts when the last records went out, for the per period deltas
+static uint32_t sent_lines[RENDER_LINE_TYPES];
+static uint32_t sent_missed[RENDER_LINE_TYPES];
+static uint32_t sent_bins[RENDER_LINE_TYPES][RENDER_STATS_BINS];
+
+#if PICO_ON_DEVICE
+// Only what fits in the CDC FIFO, so the main loop never waits on the host.
+// With no terminal open the bytes are thrown away rather than left to
+// fill the ring with stale records.
+static size_t usb_transport(const uint8_t* data, size_t length)
+{
+    if (!tud_cdc_connected())
+        return length;
+
+    uint32_t room = tud_cdc_write_available();
+    length = length < room ? length : room;
+    if (length)
+        stdio_usb.out_chars((const char*)data, (int)length);
+    return length;
+}
+#else
+static size_t stdout_transport(const uint8_t* data, size_t length)
+{
+    return fwrite(data, 1, length, stdout);
+}
+#endif
+
+static uint8_t crc8(uint8_t crc, const uint8_t* data, size_t length)
+{
+    while (length--)
+    {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+static void ring_put(const uint8_t* data, size_t length)
+{
+    while (length--)
+        ring[ring_head++ & (TELEMETRY_RING_BYTES - 1)] = *data++;
+}
+
+void TELEMETRY_init(void)
+{
+#if PICO_ON_DEVICE
+    stdio_usb_init();
+    transport = usb_transport;
+#else
+    transport = stdout_transport;
+#endif
+}
+
+void TELEMETRY_set_transport(telemetry_transport_t new_transport)
+{
+    transport = new_transport;
+}
+
+// Queues a record, or drops the whole of it if the ring is too full
+bool TELEMETRY_send(telemetry_type_t type, const void* payload, uint8_t length)
+{
+    uint8_t header[6] = { TELEMETRY_SYNC0, TELEMETRY_SYNC1, TELEMETRY_VERSION, type, sequence++, length };
+    if (TELEMETRY_RING_BYTES - (ring_head - ring_tail) < (uint32_t)length + FRAME_OVERHEAD)
+        return false;
+
+    uint8_t crc = crc8(0, &header[2], sizeof(header) - 2);
+    crc = crc8(crc, payload, length);
+    ring_put(header, sizeof(header));
+    ring_put(payload, length);
+    ring_put(&crc, 1);
+    return true;
+}
+
+void TELEMETRY_send_buttons(uint16_t pressed)
+{
+    telemetry_buttons_t record = { .time_us = time_us_32(), .pressed = pressed };
+    TELEMETRY_send(TELEMETRY_BUTTONS, &record, sizeof(record));
+}
+
+void TELEMETRY_send_touch(uint16_t x, uint16_t y, bool down)
+{
+    telemetry_touch_t record = { .time_us = time_us_32(), .x = x, .y = y, .down = down };
+    TELEMETRY_send(TELEMETRY_TOUCH, &record, sizeof(record));
+}
+
+void TELEMETRY_send_fingerprint(uint32_t fingerprint, int scheme)
+{
+    telemetry_fingerprint_t record = { .time_us = time_us_32(), .fingerprint = fingerprint, .scheme = scheme };
+    TELEMETRY_send(TELEMETRY_FINGERPRINT, &record, sizeof(record));
+}
+
+static void send_capture(uint32_t now_us)
+{
+    capture_stats_t capture;
+    CAPTURE_STATS_read(&capture);
+
+    telemetry_capture_t record =
+    {
+        .time_us = now_us,
+        .frames = capture.frames,
+        .frames_aborted = capture.frames_aborted,
+        .short_lines = capture.short_lines,
+        .late_edges = capture.late_edges,
+        .frame_us = capture.frame_us,
+        .line_cycles_min = capture.line_cycles_min,
+        .line_cycles_max = capture.line_cycles_max,
+        .pixels_min = capture.pixels_min,
+    };
+    TELEMETRY_send(TELEMETRY_CAPTURE, &record, sizeof(record));
+}
+
+// The render stats are cumulative and the performance page resets them, so
+// a count that went down means a reset and the whole count is new
+static uint16_t delta(uint32_t now, uint32_t* sent)
+{
+    uint32_t change = now >= *sent ? now - *sent : now;
+    *sent = now;
+    return change > 0xFFFF ? 0xFFFF : (uint16_t)change;
+}
+
+static void send_render(uint32_t now_us)
+{
+    for (int type = 0; type < RENDER_LINE_TYPES; type++)
+    {
+        render_stats_summary_t summary;
+        uint32_t bins[RENDER_STATS_BINS];
+        RENDER_STATS_get(type, &summary);
+        RENDER_STATS_get_bins(type, bins);
+
+        if (summary.lines < sent_lines[type])
+        {
+            sent_missed[type] = 0;
+            memset(sent_bins[type], 0, sizeof(sent_bins[type]));
+        }
+        sent_lines[type] = summary.lines;
+
+        telemetry_render_t record =
+        {
+            .time_us = now_us,
+            .line_type = type,
+            .bin_shift = RENDER_STATS_BIN_SHIFT,
+            .missed = delta(summary.missed, &sent_missed[type]),
+        };
+        for (int bin = 0; bin < RENDER_STATS_BINS; bin++)
+            record.bins[bin] = delta(bins[bin], &sent_bins[type][bin]);
+        TELEMETRY_send(TELEMETRY_RENDER, &record, sizeof(record));
+    }
+}
+
+// Queues the periodic records and writes out what the transport will take
+void TELEMETRY_tasks(void)
+{
+    static uint32_t last_period_us;
+    uint32_t now_us = time_us_32();
+    if (now_us - last_period_us >= TELEMETRY_PERIOD_US)
+    {
+        last_period_us = now_us;
+        send_capture(now_us);
+        send_render(now_us);
+    }
+
+    while (ring_tail != ring_head && transport)
+    {
+        uint32_t offset = ring_tail & (TELEMETRY_RING_BYTES - 1);
+        uint32_t length = ring_head - ring_tail;
+        if (length > TELEMETRY_RING_BYTES - offset)
+            length = TELEMETRY_RING_BYTES - offset;     // up to the end of the ring this pass
+
+        size_t written = transport(&ring[offset], length);
+        ring_tail += written;
+        if (written < length)
+            break;
+    }
+}
+
+#endif // TELEMETRY_ENABLED
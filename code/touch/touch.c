@@ -1,5 +1,3 @@
-//TODO:  handle touchmove
-
 // touch.c
 
 //*********************************************************************************************
@@ -7,17 +5,35 @@
 //*********************************************************************************************
 #include "touch.h"
 #include <string.h> // for memset
+#include "hardware/sync.h"
+#if PICO_ON_DEVICE
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/dma.h"
+#endif
 
 //*********************************************************************************************
 // CONSTANTS & MACROS
 //*********************************************************************************************
 #define DRV_I2C_INDEX                           (DRV_I2C_INDEX_1)
-#define TOUCH_INTERFACE_TASK_FREQ_HZ            (20)
+#define TOUCH_REPORT_QUEUE                      (8)       // power of two
 
 #define GT911_I2C_SLAVE_ADDRESS                 (0x5D)    // 7-bit address for 0xBA
 #define GT911_REG_CONFIG_START                  (0x8047)  // also config version
 #define GT911_REG_CONFIG_END                    (0x80FF)  // also config checksum
+#define GT911_REG_CONFIG_FRESH                  (0x8100)  // write 1 to have a new config taken
 #define GT911_CONFIG_SIZE                       (GT911_REG_CONFIG_END - GT911_REG_CONFIG_START)
+#define GT911_CONFIG_OFFSET(reg)                ((reg) - GT911_REG_CONFIG_START)
+#define GT911_REG_X_OUTPUT_MAX                  (0x8048)  // little endian
+#define GT911_REG_Y_OUTPUT_MAX                  (0x804A)  // little endian
+#define GT911_REG_TOUCH_NUMBER                  (0x804C)
+#define GT911_REG_MODULE_SWITCH1                (0x804D)  // bits 0-1 INT trigger
+#define GT911_REG_SCREEN_TOUCH_LEVEL            (0x8053)
+#define GT911_REG_SCREEN_LEAVE_LEVEL            (0x8054)
+#define GT911_REG_REFRESH_RATE                  (0x8056)  // bits 0-3 report period - 5ms
+#define GT911_INT_TRIGGER_MASK                  (0x03)
+#define GT911_INT_TRIGGER_FALLING               (0x01)
+#define GT911_REFRESH_RATE_MASK                 (0x0F)
 #define GT911_READ_XY_REG                       (0x814E)
 #define GT911_STATUS_FLAG_BUFFER_READY          (1<<7)
 #define GT911_TOUCH_POINTS_FROM_STATUS(status)  ((status) &= 0xf)
@@ -26,6 +42,13 @@
 #define LCD_WIDTH                               (800)
 #define LCD_HEIGHT                              (480)
 
+// What TOUCH_init has the GT911 run at.  The thresholds are in the
+// controller's raw units; the release level has to stay below the touch
+// level.
+#define GT911_REFRESH_PERIOD                    (0)       // 5ms, the fastest it reports
+#define GT911_TOUCH_LEVEL                       (80)
+#define GT911_LEAVE_LEVEL                       (50)
+
 //*********************************************************************************************
 // TYPE DEFINITIONS
 //*********************************************************************************************
@@ -52,6 +75,7 @@ typedef struct
     uint16_t point_x;
     uint16_t point_y;
     bool valid;
+    bool moved;         // since the last move callback
 } tracked_touch_t;
 
 // ////
@@ -68,12 +92,13 @@ typedef struct  __attribute__((packed))
   touch_point_t points[GT911_MAX_TOUCH_POINTS];
 } operating_data_GT911_t;
 
-// just a taste of the config...
+// The whole config, 0x8047 to the checksum, then config_fresh -- written
+// in one go
 typedef struct __attribute__((packed))
 {
-    uint8_t version;
-    uint16_t x_resolution;
-    uint16_t y_resolution;
+    uint8_t bytes[GT911_CONFIG_SIZE];
+    uint8_t checksum;
+    uint8_t fresh;
 } config_data_gt911_t;
 
 typedef struct
@@ -82,48 +107,170 @@ typedef struct
     touch_point_t points[MAX_TOUCH_POINTS];
 } TOUCH_DATA_t;
 
+// Touch reads run from interrupts:  the INT falling edge starts the point
+// register read, and its completion starts the status clear.
+typedef enum
+{
+    BUS_IDLE = 0,
+    BUS_READ_POINTS,
+    BUS_CLEAR_STATUS,
+} bus_state_t;
+
 //*********************************************************************************************
 // PRIVATE VARIABLES
 //*********************************************************************************************
 static i2c_inst_t* i2cHandle = NULL;
+static uint touchIntPin;
+static uint16_t touchWidth = LCD_WIDTH;
+static uint16_t touchHeight = LCD_HEIGHT;
 static tracked_touch_t tracked_touches[MAX_TOUCH_POINTS];
 static tracked_touch_t tracked_touches_previous[MAX_TOUCH_POINTS];
 
+// Written by the interrupts and TOUCH_capture_gap, which all run on core0
+// at the default priority and so never preempt each other
+static volatile bus_state_t bus_state = BUS_IDLE;
+static volatile bool int_pending = false;
+static operating_data_GT911_t point_data;
+
+// Reports from the interrupts (head) to TOUCH_tasks (tail)
+static TOUCH_DATA_t reports[TOUCH_REPORT_QUEUE];
+static volatile uint32_t reports_head = 0;
+static volatile uint32_t reports_tail = 0;
+static volatile uint32_t reports_dropped = 0;
+static volatile uint32_t transfer_errors = 0;
+
+#if PICO_ON_DEVICE
+static int tx_channel = -1;
+static int rx_channel = -1;
+static dma_channel_config tx_config;
+static dma_channel_config rx_config;
+static uint32_t commands[2 + sizeof(operating_data_GT911_t)];   // register address + a read per byte
+static bool transfer_aborted = false;
+#endif
+
 //*********************************************************************************************
 // PRIVATE FUNCTION PROTOTYPES
 //*********************************************************************************************
 
 static void HardwareInit(void);
-
-static bool GetTouchData_GT911(TOUCH_DATA_t *data);
-
-// static bool GetResolution_GT911(leSize *size);
-// static bool SetResolution_GT911(void);
+static bool Configure_GT911(void);
+
+static void TrackTouches(const TOUCH_DATA_t* data);
+static void StartTransfer_GT911(const uint8_t* write_buffer, uint8_t write_length, uint8_t* read_buffer, uint8_t read_length);
+static void TransferDone_GT911(bool ok);
+static void StartReadPoints_GT911(void);
+static void QueueReport_GT911(void);
+static void ReportReady_GT911(void);
+#if PICO_ON_DEVICE
+static void IntHandler_GT911(void);
+static void I2cIrqHandler_GT911(void);
+#endif
 
 static bool GetRegister_GT911(uint16_t registerAddress, uint8_t* read_buffer, uint8_t buffer_length);
-static bool ClearStatus_GT911(void);
+static bool SetRegister_GT911(uint16_t registerAddress, const uint8_t* write_buffer, uint8_t buffer_length);
 
-//static uint8_t Checksum_GT911(uint8_t* bytes,uint8_t length);
+static uint8_t Checksum_GT911(const uint8_t* bytes, uint8_t length);
 
-static touchDown_FnPtr touchup_callback = NULL;
+static touchUp_FnPtr touchup_callback = NULL;
 static touchDown_FnPtr touchdown_callback = NULL;
+static touchMove_FnPtr touchmove_callback = NULL;
 
 //*********************************************************************************************
 // PUBLIC FUNCTIONS
 //*********************************************************************************************
-void TOUCH_init(i2c_inst_t* i2c_instance)
+// The GT911 INT line starts each read, so the panel is read as soon as it
+// has a report rather than on a poll.  The transfers run on DMA; the CPU
+// only starts each one from an interrupt.
+//
+// The capture interrupt (IO_IRQ_BANK0, VSYNC) holds core0 for ~15ms of
+// every frame and shares its IRQ with the INT edge.  Raising the I2C
+// interrupt above it would not help -- the read could not start -- and any
+// interrupt inside the pixel loop costs the rest of that line.  Instead
+// the capture loop calls TOUCH_capture_gap between lines, so a report
+// waits at most a DMG line (~109us) plus its transfer rather than a frame.
+void TOUCH_init(i2c_inst_t* i2c_instance, uint int_pin)
 {
     i2cHandle = i2c_instance;
+    touchIntPin = int_pin;
 
     for (int i = 0; i < MAX_TOUCH_POINTS; i++)
     {
         tracked_touches[i].point_x = 0;
         tracked_touches[i].point_y = 0;
         tracked_touches[i].valid = false;
+        tracked_touches[i].moved = false;
         tracked_touches_previous[i].point_x = 0;
         tracked_touches_previous[i].point_y = 0;
         tracked_touches_previous[i].valid = false;
     }
+
+    // blocking transfers, so before the I2C interrupt takes the STOPs
+    (void)Configure_GT911();
+
+#if PICO_ON_DEVICE
+    i2c_hw_t* hw = i2c_get_hw(i2cHandle);
+
+    tx_channel = dma_claim_unused_channel(true);
+    tx_config = dma_channel_get_default_config(tx_channel);
+    channel_config_set_transfer_data_size(&tx_config, DMA_SIZE_32);
+    channel_config_set_read_increment(&tx_config, true);
+    channel_config_set_write_increment(&tx_config, false);
+    channel_config_set_dreq(&tx_config, i2c_get_dreq(i2cHandle, true));
+
+    rx_channel = dma_claim_unused_channel(true);
+    rx_config = dma_channel_get_default_config(rx_channel);
+    channel_config_set_transfer_data_size(&rx_config, DMA_SIZE_8);
+    channel_config_set_read_increment(&rx_config, false);
+    channel_config_set_write_increment(&rx_config, true);
+    channel_config_set_dreq(&rx_config, i2c_get_dreq(i2cHandle, false));
+
+    hw->dma_cr = I2C_IC_DMA_CR_TDMAE_BITS | I2C_IC_DMA_CR_RDMAE_BITS;
+    hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+
+    uint i2c_irq = I2C0_IRQ + i2c_hw_index(i2cHandle);
+    irq_set_exclusive_handler(i2c_irq, I2cIrqHandler_GT911);
+    irq_set_enabled(i2c_irq, true);
+
+    gpio_init(touchIntPin);
+    gpio_set_dir(touchIntPin, GPIO_IN);
+    gpio_add_raw_irq_handler(touchIntPin, IntHandler_GT911);
+    gpio_set_irq_enabled(touchIntPin, GPIO_IRQ_EDGE_FALL, true);
+    irq_set_enabled(IO_IRQ_BANK0, true);
+
+    // a report may already be waiting, with its INT edge long gone
+    uint32_t interrupts = save_and_disable_interrupts();
+    if (bus_state == BUS_IDLE)
+        StartReadPoints_GT911();
+    restore_interrupts(interrupts);
+#else
+    // the stand-in may already hold a report; its transfers finish before
+    // they return, so the bus is idle here
+    StartReadPoints_GT911();
+#endif
+}
+
+// Called by the capture loop in the pause between DMG lines, from the
+// capture interrupt.  Does what the INT and I2C interrupts would if the
+// capture were not holding them off:  starts the read for a new report and
+// finishes a transfer the I2C block has completed.  Idle, it is two
+// register reads.
+void __not_in_flash_func(TOUCH_capture_gap)(void)
+{
+#if PICO_ON_DEVICE
+    if (i2cHandle == NULL)
+        return;
+
+    if (i2c_get_hw(i2cHandle)->intr_stat & (I2C_IC_INTR_STAT_R_STOP_DET_BITS | I2C_IC_INTR_STAT_R_TX_ABRT_BITS))
+        I2cIrqHandler_GT911();
+    IntHandler_GT911();
+#endif
+}
+
+// The resolution the touch points are reported at
+void TOUCH_get_resolution(uint16_t* width, uint16_t* height)
+{
+    *width = touchWidth;
+    *height = touchHeight;
 }
 
 void TOUCH_set_touchup_callback(touchUp_FnPtr cb)
@@ -134,117 +281,131 @@ void TOUCH_set_touchdown_callback(touchDown_FnPtr cb)
 {
     touchdown_callback = cb;
 }
+void TOUCH_set_touchmove_callback(touchMove_FnPtr cb)
+{
+    touchmove_callback = cb;
+}
 
+// Hands the reports the interrupts queued to the callbacks.  Every touch
+// down and up is passed on, in order; a point that moved gets one move
+// callback, to where it is now, however many reports moved it.  Returns
+// true if there were any reports.
 bool TOUCH_tasks(void)
 {
-    static uint16_t pos_x = 0;
-    static uint16_t pos_y = 0;
-    static bool touching = false;
-    
-    static TOUCH_DATA_t touchData;
-
-    // Initialize the xLastWakeTime variable with the current time.
-    //TickType_t xLastWakeTime = xTaskGetTickCount();
-    static uint32_t last_poll_micros = 0;
-    uint32_t current_micros = time_us_32();
-
     if (i2cHandle == NULL)
         return false;
 
-    // Initialize the device with the proper I2C address
-    //HardwareInit();
+    if (reports_tail == reports_head)
+        return false;
 
-    // Need a slight delay to allow the i2c device to fully initialize
-    //vTaskDelay(500);
-    //sleep_ms(500);
+    while (reports_tail != reports_head)
+    {
+        TrackTouches(&reports[reports_tail & (TOUCH_REPORT_QUEUE - 1)]);
+        reports_tail++;
+    }
 
-    //TODO(void)SetResolution_GT911();
+    for (uint8_t i = 0; i < MAX_TOUCH_POINTS; i++)
+    {
+        if (!tracked_touches[i].moved)
+            continue;
 
-    // Enter the cyclic portion of the TouchInterface task
-    
-    if (current_micros - last_poll_micros < 50000)
-        return false;
+        tracked_touches[i].moved = false;
+        if (touchmove_callback != NULL)
+        {
+            touchmove_callback(i, tracked_touches[i].point_x, tracked_touches[i].point_y);
+        }
+    }
+    return true;
+}
 
-    if( GetTouchData_GT911(&touchData) == true)
+//*********************************************************************************************
+// PRIVATE FUNCTIONS
+//*********************************************************************************************
+
+static void TrackTouches(const TOUCH_DATA_t* data)
+{
+    for (int i = 0; i < GT911_MAX_TOUCH_POINTS; i++)
     {
-        for (int i = 0; i < GT911_MAX_TOUCH_POINTS; i++)
+        tracked_touches[i].valid = false;   //reset
+        for (int j = 0; j < data->pointCount; j++)
         {
-            tracked_touches[i].valid = false;   //reset
-            for (int j = 0; j < touchData.pointCount; j++)
+            if (data->points[j].track_id == i)
             {
-                if (touchData.points[j].track_id == i)
-                {
-                    tracked_touches[i].valid = true;    //TODO:  change valid to touching?
-                    tracked_touches[i].point_x = touchData.points[j].x;
-                    tracked_touches[i].point_y = touchData.points[j].y;
-                }
+                tracked_touches[i].valid = true;    //TODO:  change valid to touching?
+                tracked_touches[i].point_x = data->points[j].x;
+                tracked_touches[i].point_y = data->points[j].y;
             }
+        }
 
-            if (tracked_touches[i].valid && !tracked_touches_previous[i].valid)
+        if (tracked_touches[i].valid && !tracked_touches_previous[i].valid)
+        {
+            //touchdown
+            if (touchdown_callback != NULL)
             {
-                //touchdown
-                if (touchdown_callback != NULL)
-                {
-                    touchdown_callback(tracked_touches[i].point_x, tracked_touches[i].point_y);
-                }
+                touchdown_callback(i, tracked_touches[i].point_x, tracked_touches[i].point_y);
             }
-            if (!tracked_touches[i].valid && tracked_touches_previous[i].valid)
+        }
+        if (tracked_touches[i].valid && tracked_touches_previous[i].valid)
+        {
+            // still down -- TOUCH_tasks passes on where it ended up
+            if (tracked_touches[i].point_x != tracked_touches_previous[i].point_x
+                || tracked_touches[i].point_y != tracked_touches_previous[i].point_y)
             {
-                //touchup
-                if (touchup_callback != NULL)
-                {
-                    // send touchup at previous location
-                    touchup_callback(tracked_touches_previous[i].point_x, tracked_touches_previous[i].point_y);
-                }
+                tracked_touches[i].moved = true;
+            }
+        }
+        else
+        {
+            tracked_touches[i].moved = false;
+        }
+        if (!tracked_touches[i].valid && tracked_touches_previous[i].valid)
+        {
+            //touchup
+            if (touchup_callback != NULL)
+            {
+                // send touchup at previous location
+                touchup_callback(i, tracked_touches_previous[i].point_x, tracked_touches_previous[i].point_y);
             }
-
-            
-                 tracked_touches_previous[i].point_x = tracked_touches[i].point_x;
-                 tracked_touches_previous[i].point_y = tracked_touches[i].point_y;
-                 tracked_touches_previous[i].valid = tracked_touches[i].valid;
         }
 
-        // // TODO:  send touchup to previous x,y (of touchdown)?
-        // // any changes?
-        // if (memcmp(tracked_touches, tracked_touches_previous, sizeof(tracked_touches)/sizeof(tracked_touch_t)) != 0)
-        // {
-        //     for (int i = 0; i < GT911_MAX_TOUCH_POINTS; i++)
-        //     {
-        //         if (tracked_touches[i].valid && !tracked_touches_previous[i].valid)
-        //         {
-        //             //touchdown
-        //             if (touchdown_callback != NULL)
-        //             {
-        //                 touchdown_callback(tracked_touches[i].point_x, tracked_touches[i].point_y);
-        //             }
-        //         }
-        //         if (!tracked_touches[i].valid && tracked_touches_previous[i].valid)
-        //         {
-        //             //touchup
-        //             if (touchup_callback != NULL)
-        //             {
-        //                 touchup_callback(tracked_touches[i].point_x, tracked_touches[i].point_y);
-        //             }
-        //         }
-
-        //         // tracked_touches_previous[i].point_x = tracked_touches[i].point_x;
-        //         // tracked_touches_previous[i].point_y = tracked_touches[i].point_y;
-        //         // tracked_touches_previous[i].valid = tracked_touches[i].valid;
-
-        //         //TODO:  touchmove
-        //     }
-        // }
-        //    memcpy(tracked_touches_previous, tracked_touches, sizeof(tracked_touches)/sizeof(tracked_touch_t));
+        
+             tracked_touches_previous[i].point_x = tracked_touches[i].point_x;
+             tracked_touches_previous[i].point_y = tracked_touches[i].point_y;
+             tracked_touches_previous[i].valid = tracked_touches[i].valid;
     }
-    
-    last_poll_micros = time_us_32();
-    return true;
-}
-
-//*********************************************************************************************
-// PRIVATE FUNCTIONS
-//*********************************************************************************************
 
+    // // TODO:  send touchup to previous x,y (of touchdown)?
+    // // any changes?
+    // if (memcmp(tracked_touches, tracked_touches_previous, sizeof(tracked_touches)/sizeof(tracked_touch_t)) != 0)
+    // {
+    //     for (int i = 0; i < GT911_MAX_TOUCH_POINTS; i++)
+    //     {
+    //         if (tracked_touches[i].valid && !tracked_touches_previous[i].valid)
+    //         {
+    //             //touchdown
+    //             if (touchdown_callback != NULL)
+    //             {
+    //                 touchdown_callback(tracked_touches[i].point_x, tracked_touches[i].point_y);
+    //             }
+    //         }
+    //         if (!tracked_touches[i].valid && tracked_touches_previous[i].valid)
+    //         {
+    //             //touchup
+    //             if (touchup_callback != NULL)
+    //             {
+    //                 touchup_callback(tracked_touches[i].point_x, tracked_touches[i].point_y);
+    //             }
+    //         }
+
+    //         // tracked_touches_previous[i].point_x = tracked_touches[i].point_x;
+    //         // tracked_touches_previous[i].point_y = tracked_touches[i].point_y;
+    //         // tracked_touches_previous[i].valid = tracked_touches[i].valid;
+
+    //         //TODO:  touchmove
+    //     }
+    // }
+    //    memcpy(tracked_touches_previous, tracked_touches, sizeof(tracked_touches)/sizeof(tracked_touch_t));
+}
 
 static void HardwareInit(void)
 {
@@ -259,110 +420,211 @@ static void HardwareInit(void)
 }
 
 
-static bool GetTouchData_GT911(TOUCH_DATA_t *data)
+#if PICO_ON_DEVICE
+// GT911 INT falling edge -- the controller has a new report
+static void __not_in_flash_func(IntHandler_GT911)(void)
 {
-    memset(data, 0, sizeof(TOUCH_DATA_t));
-    operating_data_GT911_t operating_data;
-
-    if(GetRegister_GT911((uint16_t)GT911_READ_XY_REG, (uint8_t*)&operating_data, sizeof(operating_data_GT911_t)) == true)
-    {
-        (void)ClearStatus_GT911();
-
-        if((operating_data.buffer_status & GT911_STATUS_FLAG_BUFFER_READY) == 0)
-            return false;
+    if ((gpio_get_irq_event_mask(touchIntPin) & GPIO_IRQ_EDGE_FALL) == 0)
+        return;
+    gpio_acknowledge_irq(touchIntPin, GPIO_IRQ_EDGE_FALL);
+    ReportReady_GT911();
+}
+#endif
 
-        data->pointCount = GT911_TOUCH_POINTS_FROM_STATUS(operating_data.buffer_status);
+static void __not_in_flash_func(ReportReady_GT911)(void)
+{
+    if (bus_state == BUS_IDLE)
+        StartReadPoints_GT911();
+    else
+        int_pending = true;     // read again once this transfer is done
+}
 
-        if(data->pointCount > GT911_MAX_TOUCH_POINTS)
-            return false;
+static void __not_in_flash_func(StartReadPoints_GT911)(void)
+{
+    static const uint8_t write_buffer[2] = { GT911_READ_XY_REG >> 8, GT911_READ_XY_REG & 0xFF };
+    bus_state = BUS_READ_POINTS;
+    StartTransfer_GT911(write_buffer, sizeof(write_buffer), (uint8_t*)&point_data, sizeof(point_data));
+}
 
-        uint8_t p;
-        for(p=0;p<data->pointCount;p++)
-        {
-            data->points[p].x = (uint32_t)operating_data.points[p].x;
-            data->points[p].y = (uint32_t)operating_data.points[p].y;
-            data->points[p].track_id = operating_data.points[p].track_id;
-        }
+// Called when a transfer has finished, from the I2C interrupt
+static void __not_in_flash_func(TransferDone_GT911)(bool ok)
+{
+    if (!ok)
+        transfer_errors++;
 
-        return true;
+    if (bus_state == BUS_READ_POINTS && ok && (point_data.buffer_status & GT911_STATUS_FLAG_BUFFER_READY))
+    {
+        // the GT911 holds the next report until the status is cleared
+        static const uint8_t write_buffer[3] = { GT911_READ_XY_REG >> 8, GT911_READ_XY_REG & 0xFF, 0x00 };
+        QueueReport_GT911();
+        bus_state = BUS_CLEAR_STATUS;
+        StartTransfer_GT911(write_buffer, sizeof(write_buffer), NULL, 0);
+        return;
     }
 
-    return false;
+    bus_state = BUS_IDLE;
+    if (int_pending)
+    {
+        int_pending = false;
+        StartReadPoints_GT911();
+    }
 }
 
+static void __not_in_flash_func(QueueReport_GT911)(void)
+{
+    uint8_t status = point_data.buffer_status;
+    uint8_t count = GT911_TOUCH_POINTS_FROM_STATUS(status);
+    if (count > GT911_MAX_TOUCH_POINTS)
+        return;
 
-// static bool GetResolution_GT911(leSize *size)
-// {
-//     config_data_gt911_t config;
+    if (reports_head - reports_tail >= TOUCH_REPORT_QUEUE)
+    {
+        reports_dropped++;
+        return;
+    }
 
-//     if(GetRegister_GT911((uint16_t)GT911_REG_CONFIG_START, (uint8_t*)&config, sizeof(config_data_gt911_t)) != true)
-//     {
-//         (void)printf("GT911 - Failed to get resolution!\n");
-//         return false;
-//     }
+    TOUCH_DATA_t* data = &reports[reports_head & (TOUCH_REPORT_QUEUE - 1)];
+    memset(data, 0, sizeof(TOUCH_DATA_t));
+    data->pointCount = count;
+    for (uint8_t p = 0; p < count; p++)
+    {
+        data->points[p].x = point_data.points[p].x;
+        data->points[p].y = point_data.points[p].y;
+        data->points[p].track_id = point_data.points[p].track_id;
+    }
+    __dmb();    // the report before the head that hands it on
+    reports_head++;
+}
 
-//     if((config.version < 'A') || (config.version > 'Z'))
-//         return false;
+#if PICO_ON_DEVICE
+// Writes write_buffer, then with a repeated start reads read_length bytes.
+// The TX channel feeds the I2C block one command per byte -- a data byte
+// to write, or a read -- and the RX channel collects what is read.  The
+// I2C interrupt fires on the STOP.
+static void __not_in_flash_func(StartTransfer_GT911)(const uint8_t* write_buffer, uint8_t write_length, uint8_t* read_buffer, uint8_t read_length)
+{
+    i2c_hw_t* hw = i2c_get_hw(i2cHandle);
+    uint32_t count = 0;
 
-//     size->width = config.x_resolution;
-//     size->height = config.y_resolution;
+    for (uint8_t i = 0; i < write_length; i++)
+    {
+        bool last = (read_length == 0) && (i == write_length - 1);
+        commands[count++] = write_buffer[i] | (last ? I2C_IC_DATA_CMD_STOP_BITS : 0);
+    }
+    for (uint8_t i = 0; i < read_length; i++)
+    {
+        commands[count++] = I2C_IC_DATA_CMD_CMD_BITS
+            | (i == 0 ? I2C_IC_DATA_CMD_RESTART_BITS : 0)
+            | (i == read_length - 1 ? I2C_IC_DATA_CMD_STOP_BITS : 0);
+    }
 
-//     return true;
-// }
+    transfer_aborted = false;
+    hw->enable = 0;
+    hw->tar = GT911_I2C_SLAVE_ADDRESS;
+    hw->enable = 1;
 
-// static bool SetResolution_GT911(void)
-// {
-//     leSize current_resolution;
-//     if(GetResolution_GT911(&current_resolution) == false)
-//         return false;
+    if (read_length)
+        dma_channel_configure(rx_channel, &rx_config, read_buffer, &hw->data_cmd, read_length, true);
+    dma_channel_configure(tx_channel, &tx_config, &hw->data_cmd, commands, count, true);
+}
 
-//     if((current_resolution.width == LCD_WIDTH) && (current_resolution.height == LCD_HEIGHT))
-//         return true;
+static void __not_in_flash_func(I2cIrqHandler_GT911)(void)
+{
+    i2c_hw_t* hw = i2c_get_hw(i2cHandle);
+    uint32_t status = hw->intr_stat;
 
-//     uint8_t buffer_length = GT911_CONFIG_SIZE+1;    // full config + checksum
-//     uint8_t config[buffer_length];
+    if (status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS)
+    {
+        // stop the DMA before the abort is cleared, or it feeds the rest
+        // of the commands in as a new transfer
+        dma_channel_abort(tx_channel);
+        dma_channel_abort(rx_channel);
+        (void)hw->clr_tx_abrt;
+        transfer_aborted = true;
+    }
 
-//     // get the current config
-//     static uint8_t write_buffer[GT911_CONFIG_SIZE+4] = {0};    // address + data + checksum + 0x01 (config_fresh flag)
-//     write_buffer[0] = GT911_REG_CONFIG_START >> 8;
-//     write_buffer[1] = GT911_REG_CONFIG_START & 0xFF;
+    // an abort ends with a STOP as well, so the transfer is done on the STOP
+    if ((status & I2C_IC_INTR_STAT_R_STOP_DET_BITS) == 0)
+        return;
+    (void)hw->clr_stop_det;
 
-//     if(!DRV_I2C_WriteReadTransfer(drvI2CHandle, GT911_I2C_SLAVE_ADDRESS, write_buffer,2, config, buffer_length))  // only sending 2 bytes for now
-//     {
-//         (void)printf("GT911 - Set resolution:  Failed to get current config!\n");
-//         return false;
-//     }
+    // the last byte reaches the FIFO just before the STOP
+    while (!transfer_aborted && dma_channel_is_busy(rx_channel))
+        tight_loop_contents();
+
+    TransferDone_GT911(!transfer_aborted);
+}
+#else
+// Off the device the host program stands in for the GT911 (touch_host.c),
+// and a transfer is done as soon as it starts
+static void StartTransfer_GT911(const uint8_t* write_buffer, uint8_t write_length, uint8_t* read_buffer, uint8_t read_length)
+{
+    TransferDone_GT911(TOUCH_host_i2c_transfer(GT911_I2C_SLAVE_ADDRESS, write_buffer, write_length, read_buffer, read_length));
+}
 
-//     (void)printf("GT911 - Current config version:  %c\n", config[0]);
+// The stand-in's INT line falling
+void TOUCH_host_interrupt(void)
+{
+    ReportReady_GT911();
+}
+#endif
 
-//     // change the resolution
-//     config[0]++;    // set to zero to reset to 'A'
-//     config[1] = LCD_WIDTH & 0xFF;
-//     config[2] = LCD_WIDTH >> 8;
-//     config[3] = LCD_HEIGHT & 0xFF;
-//     config[4] = LCD_HEIGHT >> 8;
+// Reads the config and, if it isn't already, sets the panel resolution,
+// the fastest report rate, the touch thresholds and INT on a falling edge.
+// The GT911 keeps its config through power cycles, so after the first boot
+// this is only the read.
+static bool Configure_GT911(void)
+{
+    static config_data_gt911_t config;
+    uint8_t current[GT911_CONFIG_SIZE];
 
-//     // update checksum...
-//     config[GT911_CONFIG_SIZE] = Checksum_GT911(config, GT911_CONFIG_SIZE-1); // last byte is for checksum
+    if (!GetRegister_GT911(GT911_REG_CONFIG_START, current, sizeof(current)))
+        return false;
 
-//     memcpy(&write_buffer[2], &config[0], buffer_length);
-//     write_buffer[sizeof(write_buffer)-1] = 0x01;
+    // the points come at this resolution until a new config is taken
+    uint16_t width = current[GT911_CONFIG_OFFSET(GT911_REG_X_OUTPUT_MAX)] | (current[GT911_CONFIG_OFFSET(GT911_REG_X_OUTPUT_MAX) + 1] << 8);
+    uint16_t height = current[GT911_CONFIG_OFFSET(GT911_REG_Y_OUTPUT_MAX)] | (current[GT911_CONFIG_OFFSET(GT911_REG_Y_OUTPUT_MAX) + 1] << 8);
+    if (width && height)
+    {
+        touchWidth = width;
+        touchHeight = height;
+    }
 
-//     if(DRV_I2C_WriteTransfer(drvI2CHandle, GT911_I2C_SLAVE_ADDRESS, write_buffer,sizeof(write_buffer)))
-//     {
-//         (void)printf("GT911 - New config written.\n");
-//         return true;
-//     }
+    memcpy(config.bytes, current, sizeof(current));
+    config.bytes[GT911_CONFIG_OFFSET(GT911_REG_X_OUTPUT_MAX)] = LCD_WIDTH & 0xFF;
+    config.bytes[GT911_CONFIG_OFFSET(GT911_REG_X_OUTPUT_MAX) + 1] = LCD_WIDTH >> 8;
+    config.bytes[GT911_CONFIG_OFFSET(GT911_REG_Y_OUTPUT_MAX)] = LCD_HEIGHT & 0xFF;
+    config.bytes[GT911_CONFIG_OFFSET(GT911_REG_Y_OUTPUT_MAX) + 1] = LCD_HEIGHT >> 8;
+    config.bytes[GT911_CONFIG_OFFSET(GT911_REG_TOUCH_NUMBER)] = GT911_MAX_TOUCH_POINTS;
+    config.bytes[GT911_CONFIG_OFFSET(GT911_REG_MODULE_SWITCH1)] =
+        (current[GT911_CONFIG_OFFSET(GT911_REG_MODULE_SWITCH1)] & ~GT911_INT_TRIGGER_MASK) | GT911_INT_TRIGGER_FALLING;
+    config.bytes[GT911_CONFIG_OFFSET(GT911_REG_SCREEN_TOUCH_LEVEL)] = GT911_TOUCH_LEVEL;
+    config.bytes[GT911_CONFIG_OFFSET(GT911_REG_SCREEN_LEAVE_LEVEL)] = GT911_LEAVE_LEVEL;
+    config.bytes[GT911_CONFIG_OFFSET(GT911_REG_REFRESH_RATE)] =
+        (current[GT911_CONFIG_OFFSET(GT911_REG_REFRESH_RATE)] & ~GT911_REFRESH_RATE_MASK) | GT911_REFRESH_PERIOD;
+
+    if (memcmp(config.bytes, current, sizeof(current)) != 0)
+    {
+        // same version -- the GT911 refuses a config older than its own
+        config.checksum = Checksum_GT911(config.bytes, sizeof(config.bytes));
+        config.fresh = 1;
+        if (!SetRegister_GT911(GT911_REG_CONFIG_START, (const uint8_t*)&config, sizeof(config)))
+            return false;
+    }
 
-//     (void)printf("GT911 - Config failure.\n");
-//     return false;
-// }
+    touchWidth = LCD_WIDTH;
+    touchHeight = LCD_HEIGHT;
+    return true;
+}
 
+// Blocking transfers, only for TOUCH_init -- once the I2C interrupt is
+// enabled it clears the STOPs these wait for
 static bool GetRegister_GT911(uint16_t registerAddress, uint8_t* read_buffer, uint8_t buffer_length)
 {
     static uint8_t write_buffer[2];
     write_buffer[0] = registerAddress >> 8;
     write_buffer[1] = registerAddress & 0xFF;
+#if PICO_ON_DEVICE
     (void)i2c_write_blocking(i2cHandle, GT911_I2C_SLAVE_ADDRESS, write_buffer, sizeof(write_buffer), false);
 
     int ret = i2c_read_blocking(i2cHandle, GT911_I2C_SLAVE_ADDRESS, read_buffer, buffer_length, false);
@@ -376,32 +638,37 @@ static bool GetRegister_GT911(uint16_t registerAddress, uint8_t* read_buffer, ui
 
 
     return true;
-
-    // //uint16_t registerAddressBigEndian = __swap16gen(registerAddress);   //lint !e160
-    // uint16_t registerAddressBigEndian = (registerAddress & 0xff) << 8 | (registerAddress & 0xff00) >> 8;
-    // bool result = DRV_I2C_WriteReadTransfer(drvI2CHandle, GT911_I2C_SLAVE_ADDRESS, (void*)&registerAddressBigEndian, sizeof(registerAddressBigEndian), read_buffer, buffer_length);
-    // return result ? true : false;
+#else
+    return TOUCH_host_i2c_transfer(GT911_I2C_SLAVE_ADDRESS, write_buffer, sizeof(write_buffer), read_buffer, buffer_length);
+#endif
 }
 
-static bool ClearStatus_GT911(void)
+static bool SetRegister_GT911(uint16_t registerAddress, const uint8_t* write_buffer, uint8_t buffer_length)
 {
-    static uint8_t write_buffer[3];
-    write_buffer[0] = GT911_READ_XY_REG >> 8;
-    write_buffer[1] = GT911_READ_XY_REG & 0xFF;
-    write_buffer[2] = 0x00;
-    int ret = i2c_write_blocking(i2cHandle, GT911_I2C_SLAVE_ADDRESS, write_buffer, sizeof(write_buffer), false);
-    return ret >= 0;
+    static uint8_t buffer[2 + sizeof(config_data_gt911_t)];
+    if (buffer_length > sizeof(buffer) - 2)
+        return false;
+
+    buffer[0] = registerAddress >> 8;
+    buffer[1] = registerAddress & 0xFF;
+    memcpy(&buffer[2], write_buffer, buffer_length);
+#if PICO_ON_DEVICE
+    return i2c_write_blocking(i2cHandle, GT911_I2C_SLAVE_ADDRESS, buffer, 2 + buffer_length, false) == 2 + buffer_length;
+#else
+    return TOUCH_host_i2c_transfer(GT911_I2C_SLAVE_ADDRESS, buffer, 2 + buffer_length, NULL, 0);
+#endif
 }
 
-// static uint8_t Checksum_GT911(uint8_t* bytes, uint8_t length)
-// {
-//     uint8_t checksum = 0;
-//     uint8_t i;
-//     for(i=0; i < length; i++)
-//     {
-//        checksum += bytes[i];
-//     }
-//     checksum = (~checksum) + 1;
-
-//     return checksum;
-// }
\ No newline at end of file
+// Two's complement of the sum of the config bytes
+static uint8_t Checksum_GT911(const uint8_t* bytes, uint8_t length)
+{
+    uint8_t checksum = 0;
+    uint8_t i;
+    for(i=0; i < length; i++)
+    {
+       checksum += bytes[i];
+    }
+    checksum = (~checksum) + 1;
+
+    return checksum;
+}
@@ -43,16 +43,61 @@
 //     touch_point_t points[MAX_TOUCH_POINTS];
 // } TOUCH_DATA_t;
 
-typedef void (*touchDown_FnPtr)(uint16_t x, uint16_t y);
-typedef void (*touchUp_FnPtr)(uint16_t x, uint16_t y);
+// id is the point's track, 0 to MAX_TOUCH_POINTS-1, from its touch down to
+// its touch up
+typedef void (*touchDown_FnPtr)(uint8_t id, uint16_t x, uint16_t y);
+typedef void (*touchUp_FnPtr)(uint8_t id, uint16_t x, uint16_t y);
+typedef void (*touchMove_FnPtr)(uint8_t id, uint16_t x, uint16_t y);
 
 // ******************************************************************************************
 // PUBLIC FUNCTION PROTOTYPES
 // ******************************************************************************************
 
-void TOUCH_init(i2c_inst_t* i2c_instance);
+void TOUCH_init(i2c_inst_t* i2c_instance, uint int_pin);
 bool TOUCH_tasks(void);
+void TOUCH_capture_gap(void);
+void TOUCH_get_resolution(uint16_t* width, uint16_t* height);
 void TOUCH_set_touchup_callback(touchUp_FnPtr cb);
 void TOUCH_set_touchdown_callback(touchDown_FnPtr cb);
+void TOUCH_set_touchmove_callback(touchMove_FnPtr cb);
+
+#if !PICO_ON_DEVICE
+// Off the device there is no I2C block or panel.  touch_host.c, built into
+// the host tests (code/test), stands in for the GT911's registers:  TOUCH_host_report is a scan of the panel,
+// which raises INT (TOUCH_host_interrupt) for the driver to read it, and a
+// config written with config_fresh set is taken or refused as the part does.
+typedef struct touch_host_point_t
+{
+    uint8_t id;
+    uint16_t x;
+    uint16_t y;
+} touch_host_point_t;
+
+typedef struct touch_host_gt911_t
+{
+    uint16_t width;                 // resolution of the config in use
+    uint16_t height;
+    uint8_t touch_number;
+    uint8_t module_switch1;
+    uint8_t refresh_rate;
+    uint8_t version;
+    uint8_t checksum;
+    uint32_t config_writes;         // writes into the config registers
+    uint32_t configs_taken;         // config_fresh with a good checksum and version
+    uint32_t configs_rejected;      // config_fresh with either wrong
+    uint32_t reads;                 // transfers that read registers
+    uint32_t reports;               // scans that raised INT
+    uint32_t reports_dropped;       // scans while the last was still unread
+} touch_host_gt911_t;
+
+void TOUCH_host_reset(void);
+void TOUCH_host_report(const touch_host_point_t* points, uint8_t count);
+void TOUCH_host_set_nak(bool nak);
+void TOUCH_host_get_gt911(touch_host_gt911_t* gt911);
+
+// Writes write_buffer, then reads into read_buffer.  Returns false for a NAK.
+bool TOUCH_host_i2c_transfer(uint8_t address, const uint8_t* write_buffer, size_t write_length, uint8_t* read_buffer, size_t read_length);
+void TOUCH_host_interrupt(void);
+#endif
 
 #endif /* TOUCH_H */
@@ -0,0 +1,206 @@
+// touch_host.c
+
+//*********************************************************************************************
+// HEADER FILES
+//*********************************************************************************************
+#include "touch.h"
+#include <string.h>
+
+#if !PICO_ON_DEVICE
+
+//*********************************************************************************************
+// CONSTANTS & MACROS
+//*********************************************************************************************
+// The GT911 register map touch.c uses, from the config to the last point
+#define GT911_I2C_SLAVE_ADDRESS                 (0x5D)
+#define GT911_REG_FIRST                         (0x8040)
+#define GT911_REG_CONFIG_START                  (0x8047)
+#define GT911_REG_CONFIG_END                    (0x80FF)  // config checksum
+#define GT911_REG_CONFIG_FRESH                  (0x8100)
+#define GT911_CONFIG_SIZE                       (GT911_REG_CONFIG_END - GT911_REG_CONFIG_START + 1)
+#define GT911_REG_X_OUTPUT_MAX                  (0x8048)
+#define GT911_REG_Y_OUTPUT_MAX                  (0x804A)
+#define GT911_REG_TOUCH_NUMBER                  (0x804C)
+#define GT911_REG_MODULE_SWITCH1                (0x804D)
+#define GT911_REG_REFRESH_RATE                  (0x8056)
+#define GT911_REG_PRODUCT_ID                    (0x8140)
+#define GT911_REG_STATUS                        (0x814E)
+#define GT911_REG_POINTS                        (0x814F)
+#define GT911_POINT_SIZE                        (8)
+#define GT911_MAX_TOUCH_POINTS                  (5)
+#define GT911_REG_LAST                          (GT911_REG_POINTS + GT911_MAX_TOUCH_POINTS * GT911_POINT_SIZE - 1)
+#define GT911_STATUS_FLAG_BUFFER_READY          (1<<7)
+
+#define REG(address)                            (registers[(address) - GT911_REG_FIRST])
+#define REG16(address)                          (REG(address) | (REG((address) + 1) << 8))
+#define ACTIVE(address)                         (active_config[(address) - GT911_REG_CONFIG_START])
+#define ACTIVE16(address)                       (ACTIVE(address) | (ACTIVE((address) + 1) << 8))
+
+//*********************************************************************************************
+// PRIVATE VARIABLES
+//*********************************************************************************************
+// As modules tend to come:  configured for another panel, INT on the
+// rising edge and a 10ms report period.  Version, X and Y output max, touch
+// number, module switches, shake count, filter, large touch, noise
+// reduction, touch and leave levels, low power control, refresh rate.
+static const uint8_t default_config[] =
+{
+    0x41, 0xE0, 0x01, 0x10, 0x01, 0x05, 0x0C, 0x00, 0x22, 0x08, 0x28, 0x08, 0x28, 0x1E, 0x03, 0x05,
+};
+
+static uint8_t registers[GT911_REG_LAST - GT911_REG_FIRST + 1];
+static uint8_t active_config[GT911_CONFIG_SIZE];   // the config taken, checksum included
+static bool powered = false;
+static bool nak = false;
+static touch_host_gt911_t counts;
+
+//*********************************************************************************************
+// PRIVATE FUNCTIONS
+//*********************************************************************************************
+
+static uint8_t Checksum(uint16_t first, uint16_t last)
+{
+    uint8_t checksum = 0;
+    for (uint16_t address = first; address <= last; address++)
+    {
+        checksum += REG(address);
+    }
+    return (~checksum) + 1;
+}
+
+static void PowerOn(void)
+{
+    if (!powered)
+        TOUCH_host_reset();
+}
+
+static uint8_t ReadRegister(uint16_t address)
+{
+    if (address < GT911_REG_FIRST || address > GT911_REG_LAST)
+        return 0;
+    return REG(address);
+}
+
+static void WriteRegister(uint16_t address, uint8_t value)
+{
+    if (address < GT911_REG_FIRST || address > GT911_REG_LAST)
+        return;
+    REG(address) = value;
+}
+
+// On config_fresh the GT911 checks what was written to the config
+// registers:  it takes it if the checksum is right and the version is not
+// older than its own, and otherwise puts its own back.  Either way
+// config_fresh reads back as 0.
+static void TakeConfig(void)
+{
+    if (REG(GT911_REG_CONFIG_END) == Checksum(GT911_REG_CONFIG_START, GT911_REG_CONFIG_END - 1) &&
+        REG(GT911_REG_CONFIG_START) >= ACTIVE(GT911_REG_CONFIG_START))
+    {
+        memcpy(active_config, &REG(GT911_REG_CONFIG_START), GT911_CONFIG_SIZE);
+        counts.configs_taken++;
+    }
+    else
+    {
+        memcpy(&REG(GT911_REG_CONFIG_START), active_config, GT911_CONFIG_SIZE);
+        counts.configs_rejected++;
+    }
+    REG(GT911_REG_CONFIG_FRESH) = 0;
+}
+
+//*********************************************************************************************
+// PUBLIC FUNCTIONS
+//*********************************************************************************************
+// Power on state:  the default config taken, no report and no NAKs
+void TOUCH_host_reset(void)
+{
+    memset(registers, 0, sizeof(registers));
+    memcpy(&REG(GT911_REG_CONFIG_START), default_config, sizeof(default_config));
+    REG(GT911_REG_CONFIG_END) = Checksum(GT911_REG_CONFIG_START, GT911_REG_CONFIG_END - 1);
+    memcpy(active_config, &REG(GT911_REG_CONFIG_START), GT911_CONFIG_SIZE);
+    memcpy(&REG(GT911_REG_PRODUCT_ID), "911", 3);
+
+    memset(&counts, 0, sizeof(counts));
+    nak = false;
+    powered = true;
+}
+
+// A scan of the panel with count points on it -- none is the report of
+// the last finger lifting.  The GT911 keeps a report until the status is
+// cleared, so a scan before then is lost.
+void TOUCH_host_report(const touch_host_point_t* points, uint8_t count)
+{
+    PowerOn();
+    if (count > GT911_MAX_TOUCH_POINTS)
+        count = GT911_MAX_TOUCH_POINTS;
+
+    if (REG(GT911_REG_STATUS) & GT911_STATUS_FLAG_BUFFER_READY)
+    {
+        counts.reports_dropped++;
+        return;
+    }
+
+    memset(&REG(GT911_REG_POINTS), 0, GT911_MAX_TOUCH_POINTS * GT911_POINT_SIZE);
+    for (uint8_t p = 0; p < count; p++)
+    {
+        uint8_t* point = &REG(GT911_REG_POINTS + p * GT911_POINT_SIZE);
+        point[0] = points[p].id;
+        point[1] = points[p].x & 0xFF;
+        point[2] = points[p].x >> 8;
+        point[3] = points[p].y & 0xFF;
+        point[4] = points[p].y >> 8;
+        point[5] = 0x20;    // size
+    }
+    REG(GT911_REG_STATUS) = GT911_STATUS_FLAG_BUFFER_READY | count;
+    counts.reports++;
+
+    TOUCH_host_interrupt();
+}
+
+// While set, every transfer is NAKed, as with the controller in reset
+void TOUCH_host_set_nak(bool set)
+{
+    nak = set;
+}
+
+void TOUCH_host_get_gt911(touch_host_gt911_t* gt911)
+{
+    PowerOn();
+    *gt911 = counts;
+    gt911->width = ACTIVE16(GT911_REG_X_OUTPUT_MAX);
+    gt911->height = ACTIVE16(GT911_REG_Y_OUTPUT_MAX);
+    gt911->touch_number = ACTIVE(GT911_REG_TOUCH_NUMBER);
+    gt911->module_switch1 = ACTIVE(GT911_REG_MODULE_SWITCH1);
+    gt911->refresh_rate = ACTIVE(GT911_REG_REFRESH_RATE);
+    gt911->version = ACTIVE(GT911_REG_CONFIG_START);
+    gt911->checksum = ACTIVE(GT911_REG_CONFIG_END);
+}
+
+// The first two bytes written set the register address; the rest are
+// written from there, and a read starts back at that address
+bool TOUCH_host_i2c_transfer(uint8_t address, const uint8_t* write_buffer, size_t write_length, uint8_t* read_buffer, size_t read_length)
+{
+    PowerOn();
+    if (address != GT911_I2C_SLAVE_ADDRESS || nak || write_length < 2)
+        return false;
+
+    uint16_t first = (write_buffer[0] << 8) | write_buffer[1];
+    for (size_t i = 2; i < write_length; i++)
+    {
+        WriteRegister(first + i - 2, write_buffer[i]);
+    }
+    if (write_length > 2 && first <= GT911_REG_CONFIG_END && first + write_length - 2 > GT911_REG_CONFIG_START)
+        counts.config_writes++;
+    if (REG(GT911_REG_CONFIG_FRESH))
+        TakeConfig();
+
+    if (read_length)
+        counts.reads++;
+    for (size_t i = 0; i < read_length; i++)
+    {
+        read_buffer[i] = ReadRegister(first + i);
+    }
+    return true;
+}
+
+#endif // !PICO_ON_DEVICE